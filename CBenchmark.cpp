@@ -0,0 +1,290 @@
+#include "CBenchmark.h"
+#include "CGame.h"
+#include "CMap.h"
+#include "CSurface.h"
+#include "globals.h"
+#include "helpers/format.hpp"
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+// number of frames rendered for each camera path
+const int PATH_FRAMES = 300;
+const double PI = 3.14159265358979323846;
+
+enum CameraPath
+{
+    PATH_PAN_EAST = 0,
+    PATH_PAN_SOUTH,
+    PATH_PAN_DIAGONAL,
+    PATH_WRAP_CORNER,
+    PATH_COUNT
+};
+const std::array<const char*, PATH_COUNT> pathNames = {"pan east", "pan south", "pan diagonal", "wrap corner"};
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(const Clock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// nearest rank percentile of sorted values
+double percentile(const std::vector<double>& sortedValues, int p)
+{
+    size_t rank = (sortedValues.size() * p + 99) / 100;
+    return sortedValues[std::max<size_t>(rank, 1) - 1];
+}
+
+// deterministic hash of a vertex position (the benchmark must draw the same map on every run)
+unsigned vertexHash(unsigned x, unsigned y)
+{
+    unsigned h = x * 374761393u + y * 668265263u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    return h ^ (h >> 16);
+}
+
+void printMemoryUsage(const std::string& mapName, const bobMAP& map)
+{
+    const size_t bytes = map.getMemoryUsage();
+    std::cout << helpers::format("%-24s vertex data: %.2f MB (%u bytes per vertex, %u in MapNode)\n", mapName, bytes / (1024. * 1024.),
+                                 static_cast<unsigned>(bytes / map.vertex.size()), static_cast<unsigned>(sizeof(MapNode)));
+}
+
+// calculates the light of the whole map in batches (get_nodeVectors) and vertex by vertex (update_nodeVector), the results
+// may only differ by the rounding of the batch version
+bool checkLighting(const std::string& mapName, bobMAP& map)
+{
+    Clock::time_point start = Clock::now();
+    CSurface::get_nodeVectors(map);
+    const double batchTime = msSince(start);
+    const std::vector<vector> batchNormals = map.normVectors;
+    std::vector<Sint32> batchLight;
+    for(const MapNode& vertex : map.vertex)
+        batchLight.push_back(vertex.i);
+
+    start = Clock::now();
+    for(int y = 0; y < map.height; y++)
+    {
+        for(int x = 0; x < map.width; x++)
+            CSurface::update_nodeVector(map, x, y);
+    }
+    const double vertexTime = msSince(start);
+
+    float maxNormalDiff = 0;
+    Sint32 maxLightDiff = 0;
+    for(size_t i = 0; i < map.vertex.size(); i++)
+    {
+        const vector& normal = map.normVectors[i];
+        maxNormalDiff = std::max({maxNormalDiff, std::abs(normal.x - batchNormals[i].x), std::abs(normal.y - batchNormals[i].y),
+                                  std::abs(normal.z - batchNormals[i].z)});
+        maxLightDiff = std::max(maxLightDiff, std::abs(map.vertex[i].i - batchLight[i]));
+    }
+    const bool ok = maxNormalDiff <= 1e-5f && maxLightDiff <= 1;
+    std::cout << helpers::format("%-24s light: %.2f ms (with flat vectors), vertex by vertex %.2f ms, difference %g / %d: %s\n", mapName,
+                                 batchTime, vertexTime, maxNormalDiff, maxLightDiff, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// period of the callback in checkCallbackTiming() (the one of the minimap) and the ticks it was called at
+const Uint32 CALLBACK_PERIOD = 250;
+std::vector<Uint32> callbackTicks;
+
+void recordCallback(int Param)
+{
+    if(Param == CALL_FROM_GAMELOOP)
+        callbackTicks.push_back(SDL_GetTicks());
+}
+} // namespace
+
+CBenchmark::CBenchmark(std::vector<std::string> mapFiles) : mapFiles_(std::move(mapFiles)), Surf_Field(nullptr) {}
+
+CBenchmark::~CBenchmark()
+{
+    SDL_FreeSurface(Surf_Field);
+}
+
+int CBenchmark::Execute()
+{
+    if(!global::s2->Init())
+        return 1;
+
+    auto* MapObj = new CMap("");
+    global::s2->setMapObj(MapObj);
+
+    std::cout << "\n\nmap                      bpp  path           frames  render p50/p95/p99 [ms]  field p50/p95/p99 [ms]  triangles  "
+                 "Mpixel\n";
+
+    bool lightingOk = true;
+    for(const std::string& file : mapFiles_)
+    {
+        std::cout << "Loading file: " << file << "...";
+        if(!boost::filesystem::exists(file))
+        {
+            std::cout << "failure\n";
+            continue;
+        }
+        std::cout << "\n";
+        MapObj->destructMap();
+        MapObj->constructMap(file);
+        const std::string mapName = boost::filesystem::path(file).filename().string();
+        printMemoryUsage(mapName, *MapObj->getMap());
+        lightingOk &= checkLighting(mapName, *MapObj->getMap());
+        for(int bpp : {32, 8})
+            benchmarkMap(*MapObj, mapName, bpp);
+    }
+
+    const std::array<MapType, 3> types = {MAP_GREENLAND, MAP_WASTELAND, MAP_WINTERLAND};
+    const std::array<const char*, 3> typeNames = {"greenland", "wasteland", "winterland"};
+    for(int size : {64, 128, 256})
+    {
+        for(unsigned i = 0; i < types.size(); i++)
+        {
+            MapObj->destructMap();
+            MapObj->constructMap("", size, size, types[i], TRIANGLE_TEXTURE_MEADOW1, 4, TRIANGLE_TEXTURE_WATER);
+            addRelief(*MapObj->getMap());
+            const std::string mapName = helpers::format("%s %dx%d", typeNames[i], size, size);
+            printMemoryUsage(mapName, *MapObj->getMap());
+            lightingOk &= checkLighting(mapName, *MapObj->getMap());
+            for(int bpp : {32, 8})
+                benchmarkMap(*MapObj, mapName, bpp);
+        }
+    }
+
+    global::s2->delMapObj();
+    const bool callbacksOk = checkCallbackTiming();
+    global::s2->Cleanup();
+    return lightingOk && callbacksOk ? 0 : 1;
+}
+
+bool CBenchmark::checkCallbackTiming()
+{
+    CGame& game = *global::s2;
+    callbackTicks.clear();
+    if(!game.RegisterCallback(recordCallback, CALLBACK_PERIOD))
+        return false;
+    const Uint32 start = SDL_GetTicks();
+    while(SDL_GetTicks() - start < 10 * CALLBACK_PERIOD)
+    {
+        SDL_Event Event;
+        CGame::WaitForEvent(Event, game.getFrameTimeout());
+        game.lastFrameTicks = SDL_GetTicks();
+        game.GameLoop();
+    }
+    game.UnregisterCallback(recordCallback);
+
+    // the first call is one period after registering
+    Uint32 maxLateness = 0;
+    Uint32 last = start;
+    for(Uint32 ticks : callbackTicks)
+    {
+        maxLateness = std::max(maxLateness, ticks - last > CALLBACK_PERIOD ? ticks - last - CALLBACK_PERIOD : 0);
+        last = ticks;
+    }
+    const bool ok = callbackTicks.size() >= 9 && maxLateness <= CGame::CALLBACK_WHEEL_MS;
+    std::cout << helpers::format("callback every %u ms: %u calls, at most %u ms late: %s\n", CALLBACK_PERIOD,
+                                 static_cast<unsigned>(callbackTicks.size()), maxLateness, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+void CBenchmark::addRelief(bobMAP& map)
+{
+    const std::array<TriangleTerrainType, 8> textures = {
+      TRIANGLE_TEXTURE_MEADOW1, TRIANGLE_TEXTURE_MEADOW2, TRIANGLE_TEXTURE_STEPPE, TRIANGLE_TEXTURE_MINING1,
+      TRIANGLE_TEXTURE_FLOWER,  TRIANGLE_TEXTURE_SWAMP,   TRIANGLE_TEXTURE_SNOW,   TRIANGLE_TEXTURE_WATER};
+
+    for(unsigned y = 0; y < map.height; y++)
+    {
+        for(unsigned x = 0; x < map.width; x++)
+        {
+            MapNode& curVertex = map.getVertex(x, y);
+            const unsigned hash = vertexHash(x, y);
+            // smooth hills with some noise
+            curVertex.h = static_cast<Uint8>(0x0A + 4 + 4 * std::sin(x * 0.3) * std::cos(y * 0.2) + hash % 3);
+            // keep the water border of the generated map
+            if(curVertex.rsuTexture == TRIANGLE_TEXTURE_WATER)
+                continue;
+            const TriangleTerrainType texture = textures[(x / 6 + (y / 6) * 3) % textures.size()];
+            curVertex.rsuTexture = texture;
+            curVertex.usdTexture = (hash % 5 == 0) ? textures[(hash >> 8) % textures.size()] : texture;
+            // every 4th vertex gets a pine tree (with different animation states)
+            if(hash % 4 == 0 && texture != TRIANGLE_TEXTURE_WATER)
+            {
+                curVertex.objectInfo = 0xC4;
+                curVertex.objectType = 0x30 + (hash >> 4) % 8;
+            }
+        }
+    }
+    map.updateVertexCoords();
+    CSurface::get_nodeVectors(map);
+}
+
+void CBenchmark::benchmarkMap(CMap& MapObj, const std::string& mapName, int bpp)
+{
+    MapObj.setBitsPerPixel(bpp);
+    const bobMAP& map = *MapObj.getMap();
+    const Extent screenSize = global::s2->GameResolution;
+
+    SDL_FreeSurface(Surf_Field);
+    Surf_Field = SDL_CreateRGBSurface(SDL_SWSURFACE, screenSize.x, screenSize.y, bpp, 0, 0, 0, 0);
+    if(!Surf_Field)
+        return;
+
+    // every pan crosses the whole map once, so the wrap edges are always part of the path
+    const int stepX = std::max(4, map.width_pixel / PATH_FRAMES + 1);
+    const int stepY = std::max(4, map.height_pixel / PATH_FRAMES + 1);
+    const Position mapCorner(map.width_pixel - static_cast<int>(screenSize.x) / 2, map.height_pixel - static_cast<int>(screenSize.y) / 2);
+
+    for(int path = 0; path < PATH_COUNT; path++)
+    {
+        DisplayRectangle displayRect = MapObj.getDisplayRect();
+        displayRect.setOrigin(path == PATH_WRAP_CORNER ? mapCorner : Position(0, 0));
+        MapObj.setDisplayRect(displayRect);
+        // first frame creates the map surface and is not timed
+        MapObj.render();
+
+        std::vector<double> renderTimes, fieldTimes;
+        unsigned long triangles = 0, pixels = 0;
+        for(int frame = 0; frame < PATH_FRAMES; frame++)
+        {
+            switch(path)
+            {
+                case PATH_PAN_EAST: MapObj.moveMap(Position(stepX, 0)); break;
+                case PATH_PAN_SOUTH: MapObj.moveMap(Position(0, stepY)); break;
+                case PATH_PAN_DIAGONAL: MapObj.moveMap(Position(stepX, stepY)); break;
+                case PATH_WRAP_CORNER:
+                {
+                    // circle around the corner where all four map edges meet
+                    const double angle = frame * 2 * PI / 60;
+                    displayRect.setOrigin(mapCorner
+                                          + Position(static_cast<int>(96 * std::cos(angle)), static_cast<int>(96 * std::sin(angle))));
+                    MapObj.setDisplayRect(displayRect);
+                    break;
+                }
+                default: break;
+            }
+
+            Clock::time_point start = Clock::now();
+            MapObj.render();
+            renderTimes.push_back(msSince(start));
+
+            start = Clock::now();
+            CSurface::DrawTriangleField(Surf_Field, MapObj.getDisplayRect(), map);
+            fieldTimes.push_back(msSince(start));
+            triangles += CSurface::drawnTriangles;
+            pixels += CSurface::drawnPixels;
+        }
+
+        std::sort(renderTimes.begin(), renderTimes.end());
+        std::sort(fieldTimes.begin(), fieldTimes.end());
+        std::cout << helpers::format("%-24s %3d  %-13s %7d  %6.2f %6.2f %6.2f         %6.2f %6.2f %6.2f        %9lu  %6.2f\n",
+                                     mapName, bpp, pathNames[path], PATH_FRAMES, percentile(renderTimes, 50),
+                                     percentile(renderTimes, 95), percentile(renderTimes, 99), percentile(fieldTimes, 50),
+                                     percentile(fieldTimes, 95), percentile(fieldTimes, 99), triangles / PATH_FRAMES,
+                                     pixels / PATH_FRAMES / 1e6);
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef _CBENCHMARK_H
+#define _CBENCHMARK_H
+
+#include "defines.h"
+#include <string>
+#include <vector>
+
+class CMap;
+
+// Headless benchmark of the map renderer (started with "--benchmark [mapfile ...]").
+// Moves the display rectangle along scripted camera paths over generated maps of several sizes and landscapes
+// (and over the given map files) and prints the memory used by the vertex data and frame time percentiles of CMap::render
+// and CSurface::DrawTriangleField. Fails if the batch light calculation differs from the one for single vertices or if a periodic
+// callback is called more than one tick of the timer wheel after it is due.
+class CBenchmark
+{
+private:
+    // map files given on the command line
+    std::vector<std::string> mapFiles_;
+    // surface for timing DrawTriangleField alone
+    SDL_Surface* Surf_Field;
+
+    // one map benchmarked with all camera paths at the given bits per pixel
+    void benchmarkMap(CMap& MapObj, const std::string& mapName, int bpp);
+    // adds heights, textures and trees to a generated map so it is not a flat meadow
+    static void addRelief(bobMAP& map);
+    // runs the gameloop like CGame::Execute() without input and checks when a periodic callback is called
+    static bool checkCallbackTiming();
+
+public:
+    explicit CBenchmark(std::vector<std::string> mapFiles);
+    ~CBenchmark();
+    int Execute();
+};
+
+#endif
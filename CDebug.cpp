@@ -48,10 +48,16 @@ CDebug::CDebug(void dbgCallback(int), int quitParam)
     shadingText = nullptr;
     unknown5Text = nullptr;
     editorModeText = nullptr;
+    ProfilerHeaderText = nullptr;
+    ProfilerStageTexts.fill(nullptr);
+    TrianglesText = nullptr;
+    BlitsText = nullptr;
     fontsize = 9;
     MapObj = global::s2->MapObj;
     map = nullptr;
-    global::s2->RegisterCallback(dbgCallback);
+    global::s2->RegisterCallback(dbgCallback, 100);
+    // measure the frame stages while the debugger is open
+    CProfiler::enabled = true;
 
     // add buttons for in-/decrementing msWait
     dbgWnd->addButton(dbgCallback, DECREMENT_MSWAIT, 75, 30, 15, 15, BUTTON_GREY, "-");
@@ -87,6 +93,7 @@ CDebug::~CDebug()
 {
     global::s2->UnregisterCallback(dbgCallback_);
     dbgWnd->setWaste();
+    CProfiler::enabled = false;
 }
 
 void CDebug::sendParam(int Param)
@@ -116,19 +123,20 @@ void CDebug::actualizeData()
     // write new FrameCounterText and draw it
     FrameCounterText->setText("Actual Frame: " + std::to_string(global::s2->FrameCounter));
 
-    // Frames per Second
-    static Uint32 tmpFrameCtr = 0, tmpTickCtr = SDL_GetTicks();
-    if(tmpFrameCtr == 10)
+    // Frames per Second (the debugger is not called each frame, so count the rendered frames)
+    static unsigned long tmpFrameCtr = global::s2->FrameCounter;
+    static Uint32 tmpTickCtr = SDL_GetTicks();
+    if(SDL_GetTicks() - tmpTickCtr >= 1000)
     {
         // write new FramesPerSecText and draw it
         if(!FramesPerSecText)
             FramesPerSecText = dbgWnd->addText("", 0, 20, fontsize);
-        FramesPerSecText->setText(helpers::format("Frames per Sec: %.2f", tmpFrameCtr / (((float)SDL_GetTicks() - tmpTickCtr) / 1000)));
+        FramesPerSecText->setText(helpers::format("Frames per Sec: %.2f", (global::s2->FrameCounter - tmpFrameCtr)
+                                                                            / (((float)SDL_GetTicks() - tmpTickCtr) / 1000)));
         // set new values
-        tmpFrameCtr = 0;
+        tmpFrameCtr = global::s2->FrameCounter;
         tmpTickCtr = SDL_GetTicks();
-    } else
-        tmpFrameCtr++;
+    }
 
     // del msWaitText before drawing new
     if(!msWaitText)
@@ -170,12 +178,37 @@ void CDebug::actualizeData()
     DisplayRectText->setText(helpers::format("DisplayRect: (%d,%d)->(%d,%d)\n= size(%d, %d)", displayRect.left, displayRect.top,
                                              displayRect.right, displayRect.bottom, displayRect.getSize().x, displayRect.getSize().y));
 
+    // frame profiler
+    if(!ProfilerHeaderText)
+        ProfilerHeaderText =
+          dbgWnd->addText(helpers::format("Stage  p50/p95/p99 of %d frames [ms]", CProfiler::HISTORY_SIZE), 0, 115, fontsize);
+    for(int i = 0; i < PROFILE_STAGE_COUNT; i++)
+    {
+        const auto stage = static_cast<ProfilerStage>(i);
+        if(!ProfilerStageTexts[i])
+            ProfilerStageTexts[i] = dbgWnd->addText("", 0, 125 + i * 10, fontsize);
+        ProfilerStageTexts[i]->setText(helpers::format("%s: %.2f / %.2f / %.2f", CProfiler::getStageName(stage),
+                                                       CProfiler::getPercentile(stage, 50), CProfiler::getPercentile(stage, 95),
+                                                       CProfiler::getPercentile(stage, 99)));
+    }
+    if(!TrianglesText)
+        TrianglesText = dbgWnd->addText("", 0, 125 + PROFILE_STAGE_COUNT * 10, fontsize);
+    TrianglesText->setText(helpers::format("Triangles sub/cull/drawn: %d/%d/%d", CProfiler::getCounter(PROFILE_TRIANGLES_SUBMITTED),
+                                           CProfiler::getCounter(PROFILE_TRIANGLES_CULLED),
+                                           CProfiler::getCounter(PROFILE_TRIANGLES_DRAWN)));
+    if(!BlitsText)
+        BlitsText = dbgWnd->addText("", 0, 135 + PROFILE_STAGE_COUNT * 10, fontsize);
+    BlitsText->setText("Blits: " + std::to_string(CProfiler::getCounter(PROFILE_BLITS)));
+
     // we will now write the map data if a map is active
     MapObj = global::s2->MapObj;
     if(MapObj)
     {
         map = MapObj->map;
         const MapNode& vertex = map->getVertex(MapObj->VertexX_, MapObj->VertexY_);
+        const vector& normVector = map->getNormVector(MapObj->VertexX_, MapObj->VertexY_);
+        const vector& flatVector = map->getFlatVector(MapObj->VertexX_, MapObj->VertexY_);
+        const unsigned idx = MapObj->VertexY_ * map->width + MapObj->VertexX_;
 
         if(!MapNameText)
             MapNameText = dbgWnd->addText("", 260, 10, fontsize);
@@ -200,16 +233,14 @@ void CDebug::actualizeData()
         VertexText->setText(helpers::format("Vertex: %d, %d", MapObj->VertexX_, MapObj->VertexY_));
         if(!VertexDataText)
             VertexDataText = dbgWnd->addText("", 260, 70, fontsize);
-        VertexDataText->setText(helpers::format("Vertex Data: x=%d, y=%d, z=%d i=%.2f h=%#04x", vertex.x, vertex.y, vertex.z,
+        VertexDataText->setText(helpers::format("Vertex Data: x=%d, y=%d, z=%d i=%.2f h=%#04x", vertex.getX(), vertex.getY(), vertex.getZ(),
                                                 ((float)vertex.i) / pow(2, 16), vertex.h));
         if(!VertexVectorText)
             VertexVectorText = dbgWnd->addText("", 260, 80, fontsize);
-        VertexVectorText->setText(
-          helpers::format("Vertex Vector: (%.2f, %.2f, %.2f)", vertex.normVector.x, vertex.normVector.y, vertex.normVector.z));
+        VertexVectorText->setText(helpers::format("Vertex Vector: (%.2f, %.2f, %.2f)", normVector.x, normVector.y, normVector.z));
         if(!FlatVectorText)
             FlatVectorText = dbgWnd->addText("", 260, 90, fontsize);
-        FlatVectorText->setText(
-          helpers::format("Flat Vector: (%.2f, %.2f, %.2f)", vertex.flatVector.x, vertex.flatVector.y, vertex.flatVector.z));
+        FlatVectorText->setText(helpers::format("Flat Vector: (%.2f, %.2f, %.2f)", flatVector.x, flatVector.y, flatVector.z));
         if(!rsuTextureText)
             rsuTextureText = dbgWnd->addText("", 260, 100, fontsize);
         rsuTextureText->setText(helpers::format("RSU-Texture: %#04x", vertex.rsuTexture));
@@ -230,16 +261,16 @@ void CDebug::actualizeData()
         animalText->setText(helpers::format("animal: %#04x", vertex.animal));
         if(!unknown1Text)
             unknown1Text = dbgWnd->addText("", 260, 160, fontsize);
-        unknown1Text->setText(helpers::format("unknown1: %#04x", vertex.unknown1));
+        unknown1Text->setText(helpers::format("unknown1: %#04x", map->unknown1[idx]));
         if(!buildText)
             buildText = dbgWnd->addText("", 260, 170, fontsize);
         buildText->setText(helpers::format("build: %#04x", vertex.build));
         if(!unknown2Text)
             unknown2Text = dbgWnd->addText("", 260, 180, fontsize);
-        unknown2Text->setText(helpers::format("unknown2: %#04x", vertex.unknown2));
+        unknown2Text->setText(helpers::format("unknown2: %#04x", map->unknown2[idx]));
         if(!unknown3Text)
             unknown3Text = dbgWnd->addText("", 260, 190, fontsize);
-        unknown3Text->setText(helpers::format("unknown3: %#04x", vertex.unknown3));
+        unknown3Text->setText(helpers::format("unknown3: %#04x", map->unknown3[idx]));
         if(!resourceText)
             resourceText = dbgWnd->addText("", 260, 200, fontsize);
         resourceText->setText(helpers::format("resource: %#04x", vertex.resource));
@@ -248,7 +279,7 @@ void CDebug::actualizeData()
         shadingText->setText(helpers::format("shading: %#04x", vertex.shading));
         if(!unknown5Text)
             unknown5Text = dbgWnd->addText("", 260, 220, fontsize);
-        unknown5Text->setText(helpers::format("unknown5: %#04x", vertex.unknown5));
+        unknown5Text->setText(helpers::format("unknown5: %#04x", map->unknown5[idx]));
         if(!editorModeText)
             editorModeText = dbgWnd->addText("", 260, 230, fontsize);
         editorModeText->setText(
@@ -1,6 +1,9 @@
 #ifndef _CDEBUG_H
 #define _CDEBUG_H
 
+#include "CProfiler.h"
+#include <array>
+
 class CFont;
 class CWindow;
 class CMap;
@@ -61,6 +64,11 @@ private:
     CFont* shadingText;
     CFont* unknown5Text;
     CFont* editorModeText;
+    // texts for the frame profiler (percentiles of each stage and counters of the last frame)
+    CFont* ProfilerHeaderText;
+    std::array<CFont*, PROFILE_STAGE_COUNT> ProfilerStageTexts;
+    CFont* TrianglesText;
+    CFont* BlitsText;
     // fontsize for debugging window (remember: only 9, 11 or 14)
     int fontsize;
     // temporary pointer to Map-Object
@@ -1,17 +1,28 @@
 #include "CGame.h"
+#include "CBenchmark.h"
+#include "CMapImage.h"
 #include "CIO/CMenu.h"
 #include "CIO/CWindow.h"
 #include "CMap.h"
+#include "CProfiler.h"
+#include "CSurface.h"
+#include "CTrace.h"
 #include "RttrConfig.h"
 #include "files.h"
 #include "globals.h"
 #include <boost/filesystem.hpp>
 #include <boost/nowide/cstdio.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <limits>
 
 namespace bfs = boost::filesystem;
 
+constexpr Uint32 CGame::CALLBACK_WHEEL_MS;
+constexpr Uint32 CGame::CALLBACK_WHEEL_SLOTS;
+
 //#include <vld.h>
 
 CGame::CGame()
@@ -25,6 +36,9 @@ CGame::CGame()
 #endif
 
     msWait = 0;
+    frameCap = 0;
+    lastFrameTicks = 0;
+    needFrame = true;
 
     // mouse cursor data
     Cursor.x = 0;
@@ -38,7 +52,8 @@ CGame::CGame()
     for(auto& Window : Windows)
         Window = nullptr;
     for(auto& Callback : Callbacks)
-        Callback = nullptr;
+        Callback = ScheduledCallback{nullptr, 0, 0, false};
+    CallbackWheelTick = 0;
     MapObj = nullptr;
 }
 
@@ -53,11 +68,32 @@ int CGame::Execute()
 
     while(Running)
     {
-        while(SDL_PollEvent(&Event))
-            EventHandling(&Event);
+        // sleep until there is input or the next frame is due (animations, modifying, frame cap)
+        const bool hasEvent = WaitForEvent(Event, getFrameTimeout());
+        if(frameCap)
+        {
+            const Uint32 elapsed = SDL_GetTicks() - lastFrameTicks;
+            if(elapsed < 1000 / frameCap)
+                SDL_Delay(1000 / frameCap - elapsed);
+        }
+
+        CTrace::Scope traceScope("frame", "frame");
+        CProfiler::beginFrame();
+        {
+            CProfiler::Scope scope(PROFILE_EVENTS);
+            if(hasEvent)
+            {
+                EventHandling(&Event);
+                while(SDL_PollEvent(&Event))
+                    EventHandling(&Event);
+            }
+        }
 
+        lastFrameTicks = SDL_GetTicks();
+        needFrame = false;
         GameLoop();
         Render();
+        CProfiler::endFrame();
     }
 
     Cleanup();
@@ -65,6 +101,47 @@ int CGame::Execute()
     return 0;
 }
 
+Uint32 CGame::getFrameTimeout() const
+{
+    // without input the frame is rendered after this time anyway, so the gameloop callbacks are still called
+    const Uint32 IDLE_FRAME_MS = 250;
+
+    Uint32 frameTime = IDLE_FRAME_MS;
+    if(needFrame)
+        frameTime = 0;
+    else if(MapObj && MapObj->isActive())
+    {
+        // only wake up for animations that are visible
+        if(MapObj->isModifying())
+            frameTime = 0;
+        else if(CSurface::drawnAnimatedObjects)
+            frameTime = CSurface::OBJECT_ANIMATION_MS;
+        else if(CSurface::drawnAnimatedTextures)
+            frameTime = CSurface::TEXTURE_ANIMATION_MS;
+    }
+
+    const Uint32 now = SDL_GetTicks();
+    const Uint32 elapsed = now - lastFrameTicks;
+    Uint32 timeout = elapsed < frameTime ? frameTime - elapsed : 0;
+    // wake up for the next periodic callback
+    const Uint32 nextCallback = getNextCallbackTicks();
+    return std::min(timeout, nextCallback > now ? nextCallback - now : 0);
+}
+
+bool CGame::WaitForEvent(SDL_Event& Event, Uint32 timeout)
+{
+    // SDL 1.2 has no SDL_WaitEventTimeout(), SDL_WaitEvent() itself polls with a delay of 10 ms
+    const Uint32 start = SDL_GetTicks();
+    while(!SDL_PollEvent(&Event))
+    {
+        const Uint32 elapsed = SDL_GetTicks() - start;
+        if(elapsed >= timeout)
+            return false;
+        SDL_Delay(std::min<Uint32>(timeout - elapsed, 10));
+    }
+    return true;
+}
+
 bool CGame::RegisterMenu(CMenu* Menu)
 {
     bool success = false;
@@ -117,14 +194,6 @@ bool CGame::UnregisterMenu(CMenu* Menu)
 bool CGame::RegisterWindow(CWindow* Window)
 {
     bool success = false;
-    int highestPriority = 0;
-
-    // first find the highest priority
-    for(const auto* curWnd : Windows)
-    {
-        if(curWnd && curWnd->getPriority() > highestPriority)
-            highestPriority = curWnd->getPriority();
-    }
 
     if(!Window)
         return success;
@@ -134,7 +203,7 @@ bool CGame::RegisterWindow(CWindow* Window)
         {
             i = Window;
             i->setActive();
-            i->setPriority(highestPriority + 1);
+            RaiseWindow(i);
             success = true;
 #ifdef _ADMINMODE
             RegisteredWindows++;
@@ -161,6 +230,7 @@ bool CGame::UnregisterWindow(CWindow* Window)
                     break;
                 }
             }
+            WindowOrder.erase(std::remove(WindowOrder.begin(), WindowOrder.end(), Window), WindowOrder.end());
             delete Windows[i];
             Windows[i] = nullptr;
 #ifdef _ADMINMODE
@@ -172,15 +242,30 @@ bool CGame::UnregisterWindow(CWindow* Window)
     return false;
 }
 
-bool CGame::RegisterCallback(void (*callback)(int))
+void CGame::RaiseWindow(CWindow* Window)
+{
+    // the priority is kept for windows that ask for it
+    const int highestPriority = WindowOrder.empty() ? 0 : WindowOrder.back()->getPriority();
+    if(!WindowOrder.empty() && WindowOrder.back() == Window)
+        return;
+    WindowOrder.erase(std::remove(WindowOrder.begin(), WindowOrder.end(), Window), WindowOrder.end());
+    WindowOrder.push_back(Window);
+    Window->setPriority(highestPriority + 1);
+}
+
+bool CGame::RegisterCallback(void (*callback)(int), Uint32 period)
 {
     if(!callback)
         return false;
-    for(auto& Callback : Callbacks)
+    for(int i = 0; i < MAXCALLBACKS; i++)
     {
-        if(!Callback)
+        if(!Callbacks[i].callback)
         {
-            Callback = callback;
+            Callbacks[i] = ScheduledCallback{callback, period, SDL_GetTicks() + period, false};
+            if(period == 0)
+                FrameCallbacks.push_back(i);
+            else if(period != CALLBACK_ON_DEMAND)
+                ScheduleCallback(i);
 #ifdef _ADMINMODE
             RegisteredCallbacks++;
 #endif
@@ -194,11 +279,13 @@ bool CGame::UnregisterCallback(void (*callback)(int))
 {
     if(!callback)
         return false;
-    for(auto& Callback : Callbacks)
+    for(int i = 0; i < MAXCALLBACKS; i++)
     {
-        if(Callback == callback)
+        if(Callbacks[i].callback == callback)
         {
-            Callback = nullptr;
+            // entries in the timer wheel and the woken list are skipped in the gameloop
+            Callbacks[i].callback = nullptr;
+            FrameCallbacks.erase(std::remove(FrameCallbacks.begin(), FrameCallbacks.end(), i), FrameCallbacks.end());
 #ifdef _ADMINMODE
             RegisteredCallbacks--;
 #endif
@@ -208,6 +295,46 @@ bool CGame::UnregisterCallback(void (*callback)(int))
     return false;
 }
 
+void CGame::WakeCallback(void (*callback)(int))
+{
+    if(!callback)
+        return;
+    for(int i = 0; i < MAXCALLBACKS; i++)
+    {
+        if(Callbacks[i].callback == callback)
+        {
+            WokenCallbacks.push_back(i);
+            // the woken callback is called by the next gameloop, which must not wait for input
+            requestFrame();
+            return;
+        }
+    }
+}
+
+void CGame::ScheduleCallback(int index)
+{
+    // a slot that was already processed is only checked again after a whole turn of the wheel
+    const Uint32 tick = std::max(Callbacks[index].due / CALLBACK_WHEEL_MS, CallbackWheelTick + 1);
+    CallbackWheel[tick % CALLBACK_WHEEL_SLOTS].push_back(WheelEntry{index, Callbacks[index].due});
+}
+
+Uint32 CGame::getNextCallbackTicks() const
+{
+    // the earliest entry of the first slot with entries (they may belong to a later turn of the wheel, then we just wake up too
+    // early), but not before the slot is processed
+    for(Uint32 tick = CallbackWheelTick + 1; tick <= CallbackWheelTick + CALLBACK_WHEEL_SLOTS; tick++)
+    {
+        const std::vector<WheelEntry>& slot = CallbackWheel[tick % CALLBACK_WHEEL_SLOTS];
+        if(slot.empty())
+            continue;
+        Uint32 due = slot.front().due;
+        for(const WheelEntry& entry : slot)
+            due = std::min(due, entry.due);
+        return std::max(due, tick * CALLBACK_WHEEL_MS);
+    }
+    return SDL_GetTicks() + CALLBACK_WHEEL_SLOTS * CALLBACK_WHEEL_MS;
+}
+
 void CGame::delMapObj()
 {
     delete MapObj;
@@ -250,8 +377,44 @@ bool checkWriteable(const bfs::path& folder)
 } // namespace
 
 #undef main
-int main(int /*argc*/, char* /*argv*/ [])
+int main(int argc, char* argv[])
 {
+    // "--trace <file>" records a trace of frames, loads and edits to the file
+    // "--benchmark [mapfile ...]" runs the headless map render benchmark instead of the editor
+    // "--max-fps <n>" limits the frames per second of the editor
+    // "--render-map <mapfile> <imagefile>" renders the whole map to a BMP or PPM image instead of running the editor
+    //   "--render-threads <n>" number of threads (default: number of cores)
+    //   "--render-memory <MB>" memory used for the image (default: 256)
+    std::string traceFile;
+    Uint32 maxFps = 0;
+    bool benchmark = false;
+    std::vector<std::string> benchmarkMaps;
+    std::string renderMapFile, renderImageFile;
+    unsigned renderThreads = 0;
+    size_t renderMemoryMB = 256;
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            traceFile = argv[++i];
+        else if(std::strcmp(argv[i], "--max-fps") == 0 && i + 1 < argc)
+            maxFps = static_cast<Uint32>(std::strtoul(argv[++i], nullptr, 10));
+        else if(std::strcmp(argv[i], "--render-map") == 0 && i + 2 < argc)
+        {
+            renderMapFile = argv[++i];
+            renderImageFile = argv[++i];
+        } else if(std::strcmp(argv[i], "--render-threads") == 0 && i + 1 < argc)
+            renderThreads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if(std::strcmp(argv[i], "--render-memory") == 0 && i + 1 < argc)
+            renderMemoryMB = std::strtoul(argv[++i], nullptr, 10);
+        else if(std::strcmp(argv[i], "--benchmark") == 0)
+            benchmark = true;
+        else if(benchmark)
+            benchmarkMaps.push_back(argv[i]);
+    }
+    const bool renderMap = !renderMapFile.empty();
+    if((benchmark || renderMap) && !std::getenv("SDL_VIDEODRIVER"))
+        SDL_putenv(const_cast<char*>("SDL_VIDEODRIVER=dummy"));
+
     if(!RTTRCONFIG.Init())
     {
         std::cerr << "Failed to init program!" << std::endl;
@@ -282,19 +445,40 @@ int main(int /*argc*/, char* /*argv*/ [])
         return 1;
     }
 
+    if(!traceFile.empty() && !CTrace::start(traceFile))
+        std::cerr << "Could not start trace" << std::endl;
+
     try
     {
         global::s2 = new CGame;
+        global::s2->setFrameCap(maxFps);
+
+        if(benchmark)
+        {
+            int result = CBenchmark(std::move(benchmarkMaps)).Execute();
+            delete global::s2;
+            CTrace::stop();
+            return result;
+        }
+        if(renderMap)
+        {
+            int result = CMapImage(renderMapFile, renderImageFile, renderThreads, renderMemoryMB << 20).Execute();
+            delete global::s2;
+            CTrace::stop();
+            return result;
+        }
 
         global::s2->Execute();
     } catch(...)
     {
         std::cerr << "Unhandled Exception" << std::endl;
         delete global::s2;
+        CTrace::stop();
         WaitForEnter();
         return 1;
     }
     delete global::s2;
+    CTrace::stop();
 
     WaitForEnter();
     return 0;
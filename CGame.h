@@ -5,6 +5,7 @@
 #include <Point.h>
 #include <SDL.h>
 #include <array>
+#include <vector>
 
 class CWindow;
 class CMap;
@@ -13,6 +14,7 @@ class CMenu;
 class CGame
 {
     friend class CDebug;
+    friend class CBenchmark;
 
 public:
     Extent GameResolution;
@@ -32,6 +34,12 @@ private:
 #endif
     // milliseconds for SDL_Delay()
     Uint32 msWait;
+    // maximum frames per second (0 = unlimited)
+    Uint32 frameCap;
+    // ticks when the last frame was rendered
+    Uint32 lastFrameTicks;
+    // render the next frame even if no event arrives
+    bool needFrame;
     // structure for mouse cursor
     struct
     {
@@ -48,12 +56,51 @@ private:
     std::array<CMenu*, MAXMENUS> Menus;
     // Object for Windows
     std::array<CWindow*, MAXWINDOWS> Windows;
+    // registered windows ordered from back to front (the last one is on top)
+    std::vector<CWindow*> WindowOrder;
     // Object for Callbacks
-    std::array<void (*)(int), MAXCALLBACKS> Callbacks;
+    struct ScheduledCallback
+    {
+        void (*callback)(int);
+        // milliseconds between two calls, 0 = each frame, CALLBACK_ON_DEMAND = only after WakeCallback()
+        Uint32 period;
+        // ticks of the next call (only for periodic callbacks)
+        Uint32 due;
+        // already collected for the running gameloop
+        bool pending;
+    };
+    std::array<ScheduledCallback, MAXCALLBACKS> Callbacks;
+    // indices of the callbacks that are called each frame
+    std::vector<int> FrameCallbacks;
+    // indices of the callbacks that are called in the next gameloop
+    std::vector<int> WokenCallbacks;
+    // timer wheel with the periodic callbacks, each slot covers CALLBACK_WHEEL_MS milliseconds
+    struct WheelEntry
+    {
+        int index;
+        Uint32 due;
+    };
+    static constexpr Uint32 CALLBACK_WHEEL_MS = 10;
+    static constexpr Uint32 CALLBACK_WHEEL_SLOTS = 64;
+    std::array<std::vector<WheelEntry>, CALLBACK_WHEEL_SLOTS> CallbackWheel;
+    // last tick (ticks / CALLBACK_WHEEL_MS) the wheel was processed
+    Uint32 CallbackWheelTick;
+    // menus and windows that were set to waste and are deleted in the next gameloop
+    std::vector<CMenu*> WasteMenus;
+    std::vector<CWindow*> WasteWindows;
     // Object for the Map
     CMap* MapObj;
 
     void SetAppIcon();
+    // milliseconds the main loop may sleep before the next frame is due if no event arrives
+    Uint32 getFrameTimeout() const;
+    // like SDL_WaitEvent() but returns false if no event arrived within timeout milliseconds
+    static bool WaitForEvent(SDL_Event& Event, Uint32 timeout);
+    void ScheduleCallback(int index);
+    // moves the window on top of all others
+    void RaiseWindow(CWindow* Window);
+    // ticks of the next periodic callback that may be due
+    Uint32 getNextCallbackTicks() const;
 
 public:
     CGame();
@@ -72,12 +119,23 @@ public:
 
     void Cleanup();
 
+    // renders the next frame even if nothing changed (e.g. for content that is updated by a callback)
+    void requestFrame() { needFrame = true; }
+    void setFrameCap(Uint32 maxFps) { frameCap = maxFps; }
+
     bool RegisterMenu(CMenu* Menu);
     bool UnregisterMenu(CMenu* Menu);
     bool RegisterWindow(CWindow* Window);
     bool UnregisterWindow(CWindow* Window);
-    bool RegisterCallback(void (*callback)(int));
+    // the callback is called with CALL_FROM_GAMELOOP each frame (period 0), every period milliseconds
+    // or only after WakeCallback() (period CALLBACK_ON_DEMAND)
+    bool RegisterCallback(void (*callback)(int), Uint32 period = 0);
     bool UnregisterCallback(void (*callback)(int));
+    // calls the callback in the next gameloop (ignored if it is not registered)
+    void WakeCallback(void (*callback)(int));
+    // called by CMenu::setWaste() and CWindow::setWaste()
+    void AddWaste(CMenu* Menu) { WasteMenus.push_back(Menu); }
+    void AddWaste(CWindow* Window) { WasteWindows.push_back(Window); }
     void setMapObj(CMap* MapObj) { this->MapObj = MapObj; };
     CMap* getMapObj() { return MapObj; };
     void delMapObj();
@@ -1,5 +1,6 @@
 #include "defines.h"
 #include "CGame.h"
+#include "CIO/CFont.h"
 #include "globals.h"
 #include <SDL.h>
 
@@ -18,6 +19,8 @@ void CGame::Cleanup()
             CGame::UnregisterWindow(Window);
     }
 
+    CFont::clearCache();
+
     // free all picture surfaces
     for(auto& i : global::bmpArray)
     {
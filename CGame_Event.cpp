@@ -15,23 +15,14 @@ void CGame::EventHandling(SDL_Event* Event)
             // NOTE: we will now deliver the data to menus, windows, map etc., sometimes we have to break the switch and stop
             //      delivering earlier, for doing this we make use of a variable showing us the deliver status
             bool delivered = false;
-            // now we walk through the windows and find out, if cursor is on one of these (ordered by priority)
-            // we have to change the prioritys of the windows (for rendering), so find the highest one
-            int highestPriority = 0;
-            for(auto& Window : Windows)
+            // only the window on top gets the keyboard data
+            if(!WindowOrder.empty())
             {
-                if(Window && Window->getPriority() > highestPriority)
-                    highestPriority = Window->getPriority();
-            }
-
-            for(auto& Window : Windows)
-            {
-                if(Window && !Window->isWaste() && Window->isMarked() && Window->getPriority() == highestPriority
-                   && Window->hasActiveInputElement())
+                CWindow* Window = WindowOrder.back();
+                if(!Window->isWaste() && Window->isMarked() && Window->hasActiveInputElement())
                 {
                     Window->setKeyboardData(Event->key);
                     delivered = true;
-                    break;
                 }
             }
             // if (delivered)
@@ -85,6 +76,7 @@ void CGame::EventHandling(SDL_Event* Event)
                         bobMAP* myMap = MapObj->getMap();
                         myMap->updateVertexCoords();
                         CSurface::get_nodeVectors(*myMap);
+                        MapObj->invalidateOverview();
                         callback::PleaseWait(WINDOW_QUIT_MESSAGE);
                     }
                     break;
@@ -99,6 +91,7 @@ void CGame::EventHandling(SDL_Event* Event)
                         bobMAP* myMap = MapObj->getMap();
                         myMap->updateVertexCoords();
                         CSurface::get_nodeVectors(*myMap);
+                        MapObj->invalidateOverview();
                         callback::PleaseWait(WINDOW_QUIT_MESSAGE);
                     }
                 }
@@ -113,6 +106,7 @@ void CGame::EventHandling(SDL_Event* Event)
                         bobMAP* myMap = MapObj->getMap();
                         myMap->updateVertexCoords();
                         CSurface::get_nodeVectors(*myMap);
+                        MapObj->invalidateOverview();
                         callback::PleaseWait(WINDOW_QUIT_MESSAGE);
                     }
                     break;
@@ -168,36 +162,22 @@ void CGame::EventHandling(SDL_Event* Event)
             // NOTE: we will now deliver the data to menus, windows, map etc., sometimes we have to break the switch and stop
             //      delivering earlier, for doing this we make use of a variable showing us the deliver status
             bool delivered = false;
-            // now we walk through the windows and find out, if cursor is on one of these (ordered by priority)
-            // we have to change the prioritys of the windows (for rendering), so find the highest one
-            int highestPriority = 0;
-            for(auto& Window : Windows)
+            // now we walk through the windows from front to back and find out, if cursor is on one of these
+            for(auto it = WindowOrder.rbegin(); it != WindowOrder.rend(); ++it)
             {
-                if(Window && Window->getPriority() > highestPriority)
-                    highestPriority = Window->getPriority();
-            }
-
-            for(int actualPriority = highestPriority; actualPriority >= 0; actualPriority--)
-            {
-                for(auto& Window : Windows)
+                CWindow* Window = *it;
+                if(Window->isWaste())
+                    continue;
+                // is the cursor INSIDE the window or does the user move or resize the window?
+                if(((Event->motion.x >= Window->getX()) && (Event->motion.x < Window->getX() + Window->getW())
+                    && (Event->motion.y >= Window->getY()) && (Event->motion.y < Window->getY() + Window->getH()))
+                   || Window->isMoving() || Window->isResizing())
                 {
-                    if(Window && !Window->isWaste() && Window->getPriority() == actualPriority)
-                    {
-                        // is the cursor INSIDE the window or does the user move or resize the window?
-                        if(((Event->motion.x >= Window->getX()) && (Event->motion.x < Window->getX() + Window->getW())
-                            && (Event->motion.y >= Window->getY()) && (Event->motion.y < Window->getY() + Window->getH()))
-                           || Window->isMoving() || Window->isResizing())
-                        {
-                            // Windows[i]->setActive();
-                            // Windows[i]->setPriority(highestPriority+1);
-                            Window->setMouseData(Event->motion);
-                            delivered = true;
-                            break;
-                        }
-                    }
-                }
-                if(delivered)
+                    // the window may register new windows, so stop iterating
+                    Window->setMouseData(Event->motion);
+                    delivered = true;
                     break;
+                }
             }
             // if mouse data has been delivered, stop delivering anymore
             if(delivered)
@@ -246,36 +226,24 @@ void CGame::EventHandling(SDL_Event* Event)
             // NOTE: we will now deliver the data to menus, windows, map etc., sometimes we have to break the switch and stop
             //      delivering earlier, for doing this we make use of a variable showing us the deliver status
             bool delivered = false;
-            // now we walk through the windows and find out, if cursor is on one of these (ordered by priority)
-            // we have to change the prioritys of the windows (for rendering), so find the highest one
-            int highestPriority = 0;
-            for(auto& Window : Windows)
-            {
-                if(Window && Window->getPriority() > highestPriority)
-                    highestPriority = Window->getPriority();
-            }
-
-            for(int actualPriority = highestPriority; actualPriority >= 0; actualPriority--)
+            // now we walk through the windows from front to back and find out, if cursor is on one of these
+            for(auto it = WindowOrder.rbegin(); it != WindowOrder.rend(); ++it)
             {
-                for(auto& Window : Windows)
+                CWindow* Window = *it;
+                if(Window->isWaste())
+                    continue;
+                // is the cursor INSIDE the window?
+                if((Event->button.x >= Window->getX()) && (Event->button.x < Window->getX() + Window->getW())
+                   && (Event->button.y >= Window->getY()) && (Event->button.y < Window->getY() + Window->getH()))
                 {
-                    if(Window && !Window->isWaste() && Window->getPriority() == actualPriority)
-                    {
-                        // is the cursor INSIDE the window?
-                        if((Event->button.x >= Window->getX()) && (Event->button.x < Window->getX() + Window->getW())
-                           && (Event->button.y >= Window->getY()) && (Event->button.y < Window->getY() + Window->getH()))
-                        {
-                            Window->setActive();
-                            Window->setPriority(highestPriority + 1);
-                            Window->setMouseData(Event->button);
-                            delivered = true;
-                            break;
-                        } else if(Window->isActive())
-                            Window->setInactive();
-                    }
-                }
-                if(delivered)
+                    // raising and the callbacks of the window change the window order, so stop iterating
+                    Window->setActive();
+                    RaiseWindow(Window);
+                    Window->setMouseData(Event->button);
+                    delivered = true;
                     break;
+                } else if(Window->isActive())
+                    Window->setInactive();
             }
             // if mouse data has been deliverd, stop delivering anymore
             if(delivered)
@@ -307,37 +275,20 @@ void CGame::EventHandling(SDL_Event* Event)
             // NOTE: we will now deliver the data to menus, windows, map etc., sometimes we have to break the switch and stop
             //      delivering earlier, for doing this we make use of a variable showing us the deliver status
             bool delivered = false;
-            // now we walk through the windows and find out, if cursor is on one of these (ordered by priority)
-            // we have to change the prioritys of the windows (for rendering), so find the highest one
-            int highestPriority = 0;
-            for(auto& Window : Windows)
-            {
-                if(Window && Window->getPriority() > highestPriority)
-                    highestPriority = Window->getPriority();
-            }
-
-            for(int actualPriority = highestPriority; actualPriority >= 0; actualPriority--)
+            // now we walk through the windows from front to back and find out, if cursor is on one of these
+            for(auto it = WindowOrder.rbegin(); it != WindowOrder.rend(); ++it)
             {
-                for(auto& Window : Windows)
+                CWindow* Window = *it;
+                if(Window->isWaste())
+                    continue;
+                // is the cursor INSIDE the window?
+                if((Event->button.x >= Window->getX()) && (Event->button.x < Window->getX() + Window->getW())
+                   && (Event->button.y >= Window->getY()) && (Event->button.y < Window->getY() + Window->getH()))
                 {
-                    if(Window && !Window->isWaste() && Window->getPriority() == actualPriority)
-                    {
-                        // is the cursor INSIDE the window?
-                        if((Event->button.x >= Window->getX()) && (Event->button.x < Window->getX() + Window->getW())
-                           && (Event->button.y >= Window->getY()) && (Event->button.y < Window->getY() + Window->getH()))
-                        {
-                            // Windows[i]->setActive();
-                            // Windows[i]->setPriority(highestPriority+1);
-                            Window->setMouseData(Event->button);
-                            delivered = true;
-                            break;
-                        }
-                        // else if (Windows[i]->isActive())
-                        // Windows[i]->setInactive();
-                    }
-                }
-                if(delivered)
+                    Window->setMouseData(Event->button);
+                    delivered = true;
                     break;
+                }
             }
             // if mouse data has been deliverd, stop delivering anymore
             /// We can't stop here cause of problems with the map. If user has the left mouse button pressed and modifies the vertices,
@@ -1,22 +1,82 @@
 #include "CGame.h"
 #include "CIO/CMenu.h"
 #include "CIO/CWindow.h"
+#include "CProfiler.h"
+#include <algorithm>
 
 void CGame::GameLoop()
 {
-    for(int i = 0; i < MAXCALLBACKS; i++)
+    CProfiler::Scope scope(PROFILE_GAMELOOP);
+    const Uint32 now = SDL_GetTicks();
+
+    // collect the callbacks for this gameloop: each frame callbacks, woken ones and the due ones of the timer wheel
+    std::vector<int> dueCallbacks;
+    dueCallbacks.swap(WokenCallbacks);
+    dueCallbacks.insert(dueCallbacks.end(), FrameCallbacks.begin(), FrameCallbacks.end());
+
+    const Uint32 nowTick = now / CALLBACK_WHEEL_MS;
+    // after a long frame every slot is processed only once
+    const Uint32 firstTick = std::max(CallbackWheelTick + 1, nowTick + 1 - std::min(nowTick + 1, CALLBACK_WHEEL_SLOTS));
+    CallbackWheelTick = nowTick;
+    std::vector<WheelEntry> slotEntries;
+    for(Uint32 tick = firstTick; tick <= nowTick; tick++)
+    {
+        slotEntries.clear();
+        slotEntries.swap(CallbackWheel[tick % CALLBACK_WHEEL_SLOTS]);
+        for(const WheelEntry& entry : slotEntries)
+        {
+            const ScheduledCallback& callback = Callbacks[entry.index];
+            // skip entries of unregistered or rescheduled callbacks
+            if(!callback.callback || callback.due != entry.due || callback.period == 0 || callback.period == CALLBACK_ON_DEMAND)
+                continue;
+            // due later in this tick or in a later turn of the wheel: this slot is done, so it goes to the next tick that may be due
+            if(entry.due > now)
+                ScheduleCallback(entry.index);
+            else
+                dueCallbacks.push_back(entry.index);
+        }
+    }
+
+    for(int index : dueCallbacks)
+    {
+        ScheduledCallback& callback = Callbacks[index];
+        if(!callback.callback || callback.pending)
+            continue;
+        callback.pending = true;
+        if(callback.period != 0 && callback.period != CALLBACK_ON_DEMAND)
+        {
+            // a woken callback starts a new period as well
+            callback.due = now + callback.period;
+            ScheduleCallback(index);
+        }
+    }
+    for(int index : dueCallbacks)
     {
-        if(Callbacks[i] != nullptr)
-            Callbacks[i](CALL_FROM_GAMELOOP);
+        // the callback may unregister itself or others
+        ScheduledCallback& callback = Callbacks[index];
+        if(callback.callback && callback.pending)
+        {
+            callback.pending = false;
+            callback.callback(CALL_FROM_GAMELOOP);
+        }
     }
-    for(int i = 0; i < MAXMENUS; i++)
+
+    // the menus and windows were set to waste since the last gameloop, deleting them may set others to waste
+    std::vector<CMenu*> wasteMenus;
+    wasteMenus.swap(WasteMenus);
+    for(CMenu* Menu : wasteMenus)
     {
-        if(Menus[i] != nullptr && Menus[i]->isWaste())
-            UnregisterMenu(Menus[i]);
+        // only compare the pointers, a menu could have been deleted in another way
+        auto it = std::find(Menus.begin(), Menus.end(), Menu);
+        if(it != Menus.end() && (*it)->isWaste())
+            UnregisterMenu(Menu);
     }
-    for(int i = 0; i < MAXWINDOWS; i++)
+    std::vector<CWindow*> wasteWindows;
+    wasteWindows.swap(WasteWindows);
+    for(CWindow* Window : wasteWindows)
     {
-        if(Windows[i] != nullptr && Windows[i]->isWaste())
-            UnregisterWindow(Windows[i]);
+        auto it = std::find(Windows.begin(), Windows.end(), Window);
+        if(it != Windows.end() && (*it)->isWaste())
+            UnregisterWindow(Window);
     }
 }
@@ -1,5 +1,6 @@
 #include "CGame.h"
 #include "CIO/CFile.h"
+#include "CMap.h"
 #include "CSurface.h"
 #include "SGE/sge_blib.h"
 #include "callbacks.h"
@@ -95,6 +96,8 @@ bool CGame::Init()
         std::cerr << "Failed to load game data!" << std::endl;
         return false;
     }
+    CMap::initTerrainColors();
+    CMap::initTerrainProperties();
 
     // continue loading pictures
     using namespace boost::assign;
@@ -2,6 +2,7 @@
 #include "CIO/CMenu.h"
 #include "CIO/CWindow.h"
 #include "CMap.h"
+#include "CProfiler.h"
 #include "CSurface.h"
 #include "SGE/sge_blib.h"
 #include "globals.h"
@@ -55,9 +56,11 @@ void CGame::Render()
         return;
     }
 
-    // render the map if active
+    // render the map if active (measured in its own stages)
     if(MapObj && MapObj->isActive())
-        CSurface::Draw(Surf_Display, MapObj->getSurface(), 0, 0);
+        MapObj->renderTo(Surf_Display);
+
+    CProfiler::Scope scope(PROFILE_COMPOSITION);
 
     // render active menus
     for(auto& Menu : Menus)
@@ -66,23 +69,9 @@ void CGame::Render()
             CSurface::Draw(Surf_Display, Menu->getSurface(), 0, 0);
     }
 
-    // render windows ordered by priority
-    int highestPriority = 0;
-    // first find the highest priority
-    for(auto& Window : Windows)
-    {
-        if(Window && Window->getPriority() > highestPriority)
-            highestPriority = Window->getPriority();
-    }
-    // render from lowest priority to highest
-    for(int actualPriority = 0; actualPriority <= highestPriority; actualPriority++)
-    {
-        for(auto& Window : Windows)
-        {
-            if(Window && Window->getPriority() == actualPriority)
-                CSurface::Draw(Surf_Display, Window->getSurface(), Window->getX(), Window->getY());
-        }
-    }
+    // render windows from back to front
+    for(CWindow* Window : WindowOrder)
+        CSurface::Draw(Surf_Display, Window->getSurface(), Window->getX(), Window->getY());
 
     // render mouse cursor
     if(Cursor.clicked)
@@ -98,6 +87,7 @@ void CGame::Render()
     FrameCounter++;
 #endif
 
+    scope.next(PROFILE_FLIP);
     if(CSurface::useOpenGL)
     {
         SDL_BlitSurface(Surf_Display, nullptr, Surf_DisplayGL, nullptr);
@@ -105,6 +95,7 @@ void CGame::Render()
         SDL_GL_SwapBuffers();
     } else
         SDL_Flip(Surf_Display);
+    scope.stop();
 
     SDL_Delay(msWait);
 }
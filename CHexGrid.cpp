@@ -0,0 +1,3 @@
+#include "CHexGrid.h"
+
+constexpr std::array<std::array<CHexGrid::Offset, 19>, 2> CHexGrid::offsets;
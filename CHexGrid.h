@@ -0,0 +1,108 @@
+#ifndef _CHEXGRID_H
+#define _CHEXGRID_H
+
+#include "defines.h"
+#include <array>
+
+// Topology of the vertex grid of a map. Odd rows are shifted right by half a triangle, so the x offsets of the
+// neighbours depend on the parity of the row: they are looked up in a table for even and odd rows. The map wraps
+// around at its edges, vertices that are far enough away from the edges skip the wrap checks.
+class CHexGrid
+{
+public:
+    // order of the vertices returned by getVerticesAround(): the vertex itself, its 6 neighbours and the 12 vertices
+    // of the second ring (each ring from the upper left to the lower right)
+    enum Neighbour
+    {
+        HEX_CENTER = 0,
+        HEX_UPPER_LEFT,
+        HEX_UPPER_RIGHT,
+        HEX_LEFT,
+        HEX_RIGHT,
+        HEX_LOWER_LEFT,
+        HEX_LOWER_RIGHT
+    };
+
+    CHexGrid(int width, int height) : width_(width), height_(height) {}
+    explicit CHexGrid(const bobMAP& map) : CHexGrid(map.width, map.height) {}
+
+    // coordinates may be up to one map size outside the map
+    int wrapX(int x) const { return x < 0 ? x + width_ : (x >= width_ ? x - width_ : x); }
+    int wrapY(int y) const { return y < 0 ? y + height_ : (y >= height_ ? y - height_ : y); }
+    // true if no vertex of the two rings around x,y wraps around a map edge
+    bool isInterior(int x, int y) const { return x >= 2 && y >= 2 && x < width_ - 2 && y < height_ - 2; }
+
+    Point32 getNeighbour(int x, int y, Neighbour neighbour) const
+    {
+        const Offset& offset = offsets[y & 1][neighbour];
+        return Point32(wrapX(x + offset.dx), wrapY(y + offset.dy));
+    }
+
+    // vertices around x,y: 1 (the vertex only), 7 (with the neighbours) or 19 (with the second ring)
+    template<size_t T_size>
+    void getVerticesAround(std::array<Point32, T_size>& vertices, int x, int y) const
+    {
+        static_assert(T_size == 1u || T_size == 7u || T_size == 19u, "Only 1, 7 or 19 are allowed");
+        const std::array<Offset, 19>& rowOffsets = offsets[y & 1];
+        if(isInterior(x, y))
+        {
+            for(size_t i = 0; i < T_size; i++)
+                vertices[i] = Point32(x + rowOffsets[i].dx, y + rowOffsets[i].dy);
+        } else
+        {
+            for(size_t i = 0; i < T_size; i++)
+                vertices[i] = Point32(wrapX(x + rowOffsets[i].dx), wrapY(y + rowOffsets[i].dy));
+        }
+    }
+
+private:
+    struct Offset
+    {
+        Sint8 dx, dy;
+    };
+    // offsets of the vertices around a vertex in an even (0) and an odd (1) row
+    static constexpr std::array<std::array<Offset, 19>, 2> offsets = {{
+      {{{0, 0},
+        {-1, -1},
+        {0, -1},
+        {-1, 0},
+        {1, 0},
+        {-1, 1},
+        {0, 1},
+        {-1, -2},
+        {0, -2},
+        {1, -2},
+        {-2, -1},
+        {1, -1},
+        {-2, 0},
+        {2, 0},
+        {-2, 1},
+        {1, 1},
+        {-1, 2},
+        {0, 2},
+        {1, 2}}},
+      {{{0, 0},
+        {0, -1},
+        {1, -1},
+        {-1, 0},
+        {1, 0},
+        {0, 1},
+        {1, 1},
+        {-1, -2},
+        {0, -2},
+        {1, -2},
+        {-1, -1},
+        {2, -1},
+        {-2, 0},
+        {2, 0},
+        {-1, 1},
+        {2, 1},
+        {-1, 2},
+        {0, 2},
+        {1, 2}}},
+    }};
+
+    int width_, height_;
+};
+
+#endif
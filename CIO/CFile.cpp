@@ -1,5 +1,6 @@
 #include "CFile.h"
 #include "../CSurface.h"
+#include "../CTrace.h"
 #include "../globals.h"
 #include "libendian/libendian.h"
 #include <boost/endian/conversion.hpp>
@@ -37,6 +38,7 @@ void CFile::init()
 
 void* CFile::open_file(const std::string& filename, char filetype, bool only_loadPAL)
 {
+    CTrace::Scope traceScope("open_file", "io", filename);
     void* return_value = nullptr;
 
     if(filename.empty() || !bmpArray || !shadowArray || !palArray || !palActual)
@@ -570,7 +572,7 @@ bobMAP* CFile::open_wld()
     CHECK_READ(libendian::le_read_us(&myMap->width, fp));
     CHECK_READ(libendian::le_read_us(&myMap->height, fp));
 
-    myMap->vertex.resize(myMap->width * myMap->height);
+    myMap->resizeVertices();
 
     // go to altitude information (we skip the 16 bytes long map data header that each block has)
     fseek(fp, 16, SEEK_CUR);
@@ -643,11 +645,7 @@ bobMAP* CFile::open_wld()
     // go to unknown1 data
     fseek(fp, 16, SEEK_CUR);
 
-    for(int j = 0; j < myMap->height; j++)
-    {
-        for(int i = 0; i < myMap->width; i++)
-            CHECK_READ(libendian::read(&myMap->getVertex(i, j).unknown1, 1, fp));
-    }
+    CHECK_READ(libendian::read(myMap->unknown1.data(), myMap->unknown1.size(), fp));
 
     // go to build data
     fseek(fp, 16, SEEK_CUR);
@@ -661,20 +659,12 @@ bobMAP* CFile::open_wld()
     // go to unknown2 data
     fseek(fp, 16, SEEK_CUR);
 
-    for(int j = 0; j < myMap->height; j++)
-    {
-        for(int i = 0; i < myMap->width; i++)
-            CHECK_READ(libendian::read(&myMap->getVertex(i, j).unknown2, 1, fp));
-    }
+    CHECK_READ(libendian::read(myMap->unknown2.data(), myMap->unknown2.size(), fp));
 
     // go to unknown3 data
     fseek(fp, 16, SEEK_CUR);
 
-    for(int j = 0; j < myMap->height; j++)
-    {
-        for(int i = 0; i < myMap->width; i++)
-            CHECK_READ(libendian::read(&myMap->getVertex(i, j).unknown3, 1, fp));
-    }
+    CHECK_READ(libendian::read(myMap->unknown3.data(), myMap->unknown3.size(), fp));
 
     // go to resource data
     fseek(fp, 16, SEEK_CUR);
@@ -697,11 +687,7 @@ bobMAP* CFile::open_wld()
     // go to unknown5 data
     fseek(fp, 16, SEEK_CUR);
 
-    for(int j = 0; j < myMap->height; j++)
-    {
-        for(int i = 0; i < myMap->width; i++)
-            CHECK_READ(libendian::read(&myMap->getVertex(i, j).unknown5, 1, fp));
-    }
+    CHECK_READ(libendian::read(myMap->unknown5.data(), myMap->unknown5.size(), fp));
 
     return myMap.release();
 }
@@ -713,6 +699,7 @@ bobMAP* CFile::open_swd()
 
 bool CFile::save_file(const std::string& filename, char filetype, void* data)
 {
+    CTrace::Scope traceScope("save_file", "io", filename);
     bool return_value = false;
 
     if(filename.empty() || !data)
@@ -861,7 +848,7 @@ bool CFile::save_wld(void* data)
     {
         for(int i = 0; i < myMap->width; i++)
         {
-            temp = myMap->getVertex(i, j).z / 5 + 0x0A; //-V807
+            temp = myMap->getVertex(i, j).h; //-V807
             libendian::write(&temp, 1, fp);
         }
     }
@@ -923,11 +910,7 @@ bool CFile::save_wld(void* data)
     // go to unknown1 data
     libendian::write(map_data_header, fp);
 
-    for(int j = 0; j < myMap->height; j++)
-    {
-        for(int i = 0; i < myMap->width; i++)
-            libendian::write(&myMap->getVertex(i, j).unknown1, 1, fp);
-    }
+    libendian::write(myMap->unknown1.data(), myMap->unknown1.size(), fp);
 
     // go to build data
     libendian::write(map_data_header, fp);
@@ -941,20 +924,12 @@ bool CFile::save_wld(void* data)
     // go to unknown2 data
     libendian::write(map_data_header, fp);
 
-    for(int j = 0; j < myMap->height; j++)
-    {
-        for(int i = 0; i < myMap->width; i++)
-            libendian::write(&myMap->getVertex(i, j).unknown2, 1, fp);
-    }
+    libendian::write(myMap->unknown2.data(), myMap->unknown2.size(), fp);
 
     // go to unknown3 data
     libendian::write(map_data_header, fp);
 
-    for(int j = 0; j < myMap->height; j++)
-    {
-        for(int i = 0; i < myMap->width; i++)
-            libendian::write(&myMap->getVertex(i, j).unknown3, 1, fp);
-    }
+    libendian::write(myMap->unknown3.data(), myMap->unknown3.size(), fp);
 
     // go to resource data
     libendian::write(map_data_header, fp);
@@ -977,11 +952,7 @@ bool CFile::save_wld(void* data)
     // go to unknown5 data
     libendian::write(map_data_header, fp);
 
-    for(int j = 0; j < myMap->height; j++)
-    {
-        for(int i = 0; i < myMap->width; i++)
-            libendian::write(&myMap->getVertex(i, j).unknown5, 1, fp);
-    }
+    libendian::write(myMap->unknown5.data(), myMap->unknown5.size(), fp);
 
     // at least write the map footer (ends in 0xFF)
     temp = char(0xFF);
@@ -1,7 +1,12 @@
 #include "CFont.h"
 #include "../CSurface.h"
 #include "../globals.h"
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <list>
+#include <map>
+#include <unordered_map>
 
 CFont::CFont(std::string text, unsigned x, unsigned y, unsigned fontsize, unsigned color)
     : Surf_Font(nullptr), x_(x), y_(y), string_(std::move(text))
@@ -195,6 +200,135 @@ unsigned getCharWidth(uint8_t c, unsigned fontsize, unsigned color)
         c = 109;
     return global::bmpArray[getIndexForChar(c, fontsize, color)].w;
 }
+
+// number of pictures for each font size and color
+const unsigned NUM_FONT_CHIFFRES = 115;
+// max. memory for the text run cache
+const size_t TEXT_RUN_CACHE_BYTES = 2 * 1024 * 1024;
+
+// all chiffres of one font size and color in one 8-bit surface with the palette and color key of the chiffres,
+// so compositing text from it gives exactly the same pixels as drawing each chiffre
+struct GlyphAtlas
+{
+    SDL_Surface* surface = nullptr;
+    std::array<Sint16, NUM_FONT_CHIFFRES> x;
+};
+
+// pre-composited text (same palette and color key as the atlas)
+struct TextRun
+{
+    std::string key;
+    SDL_Surface* surface;
+};
+
+std::map<unsigned, GlyphAtlas> glyphAtlases;
+// most recently used text runs first
+std::list<TextRun> textRuns;
+std::unordered_map<std::string, std::list<TextRun>::iterator> textRunIndex;
+size_t textRunBytes = 0;
+
+bool hasSamePaletteAndKey(const SDL_Surface* surface, const SDL_Surface* reference)
+{
+    const SDL_Palette* palette = surface->format->palette;
+    const SDL_Palette* refPalette = reference->format->palette;
+    return surface->format->BitsPerPixel == 8 && (surface->flags & SDL_SRCCOLORKEY)
+           && surface->format->colorkey == reference->format->colorkey && palette && palette->ncolors == refPalette->ncolors
+           && std::memcmp(palette->colors, refPalette->colors, palette->ncolors * sizeof(SDL_Color)) == 0;
+}
+
+SDL_Surface* createKeyedSurface(int w, int h, const SDL_Surface* reference)
+{
+    SDL_Surface* surface = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 8, 0, 0, 0, 0);
+    if(!surface)
+        return nullptr;
+    SDL_SetPalette(surface, SDL_LOGPAL, reference->format->palette->colors, 0, reference->format->palette->ncolors);
+    SDL_FillRect(surface, nullptr, reference->format->colorkey);
+    return surface;
+}
+
+// returns nullptr if the chiffres can not be put together in one surface
+const GlyphAtlas* getGlyphAtlas(unsigned fontsize, unsigned color)
+{
+    const unsigned key = fontsize * NUM_FONT_COLORS + color;
+    auto it = glyphAtlases.find(key);
+    if(it != glyphAtlases.end())
+        return it->second.surface ? &it->second : nullptr;
+
+    GlyphAtlas& atlas = glyphAtlases[key];
+    const unsigned firstIndex = getIndexForChar(' ', fontsize, color);
+    const SDL_Surface* reference = global::bmpArray[firstIndex].surface;
+    if(!reference || reference->format->BitsPerPixel != 8 || !(reference->flags & SDL_SRCCOLORKEY))
+        return nullptr;
+
+    int w = 0, h = 0;
+    for(unsigned i = 0; i < NUM_FONT_CHIFFRES; i++)
+    {
+        const SDL_Surface* chiffre = global::bmpArray[firstIndex + i * NUM_FONT_COLORS].surface;
+        if(!chiffre || !hasSamePaletteAndKey(chiffre, reference))
+            return nullptr;
+        atlas.x[i] = w;
+        w += chiffre->w;
+        h = std::max(h, chiffre->h);
+    }
+
+    atlas.surface = createKeyedSurface(w, h, reference);
+    if(!atlas.surface)
+        return nullptr;
+    for(unsigned i = 0; i < NUM_FONT_CHIFFRES; i++)
+        CSurface::Draw(atlas.surface, global::bmpArray[firstIndex + i * NUM_FONT_COLORS].surface, atlas.x[i], 0);
+    SDL_SetColorKey(atlas.surface, SDL_SRCCOLORKEY, reference->format->colorkey);
+    return &atlas;
+}
+
+// returns the cached text run or composites it from the glyph atlas
+const TextRun* getTextRun(const std::string& string, unsigned fontsize, unsigned color)
+{
+    std::string key = std::to_string(fontsize) + ':' + std::to_string(color) + ':' + string;
+    auto it = textRunIndex.find(key);
+    if(it != textRunIndex.end())
+    {
+        textRuns.splice(textRuns.begin(), textRuns, it->second);
+        return &textRuns.front();
+    }
+
+    const GlyphAtlas* atlas = getGlyphAtlas(fontsize, color);
+    if(!atlas)
+        return nullptr;
+
+    // chiffres may be wider than their advance (see getCharWidth)
+    int w = 0, pos_x = 0;
+    for(char chiffre : string)
+    {
+        w = std::max(w, pos_x + global::bmpArray[getIndexForChar(chiffre, fontsize, color)].w);
+        pos_x += getCharWidth(chiffre, fontsize, color);
+    }
+    SDL_Surface* surface = createKeyedSurface(std::max(w, 1), atlas->surface->h, atlas->surface);
+    if(!surface)
+        return nullptr;
+    pos_x = 0;
+    for(char chiffre : string)
+    {
+        const unsigned index = getIndexForChar(chiffre);
+        const SDL_Surface* picture = global::bmpArray[getIndexForChar(chiffre, fontsize, color)].surface;
+        CSurface::Draw(surface, atlas->surface, pos_x, 0, atlas->x[index], 0, picture->w, picture->h);
+        pos_x += getCharWidth(chiffre, fontsize, color);
+    }
+    SDL_SetColorKey(surface, SDL_SRCCOLORKEY | SDL_RLEACCEL, atlas->surface->format->colorkey);
+
+    textRunBytes += surface->pitch * surface->h;
+    textRuns.push_front(TextRun{key, surface});
+    textRunIndex[std::move(key)] = textRuns.begin();
+    // evict the least recently used text runs
+    while(textRunBytes > TEXT_RUN_CACHE_BYTES && textRuns.size() > 1)
+    {
+        const TextRun& oldest = textRuns.back();
+        textRunBytes -= oldest.surface->pitch * oldest.surface->h;
+        SDL_FreeSurface(oldest.surface);
+        textRunIndex.erase(oldest.key);
+        textRuns.pop_back();
+    }
+    return &textRuns.front();
+}
 } // namespace
 
 bool CFont::writeText()
@@ -288,8 +422,6 @@ bool CFont::writeText()
 bool CFont::writeText(SDL_Surface* Surf_Dest, const std::string& string, unsigned x, unsigned y, unsigned fontsize, unsigned color,
                       FontAlign align)
 {
-    // data for necessary counting pixels depending on alignment
-    unsigned pixel_ctr_w = 0;
     // counter for the drawed pixels (cause we dont want to draw outside of the surface)
     unsigned pos_x = x;
     unsigned pos_y = y;
@@ -305,58 +437,56 @@ bool CFont::writeText(SDL_Surface* Surf_Dest, const std::string& string, unsigne
     if(Surf_Dest->h < static_cast<int>(y + fontsize))
         return false;
 
-    // in case of right or middle alignment we must count the pixels first
-    auto pixel_count_loop = (align == ALIGN_MIDDLE) || (align == ALIGN_RIGHT);
+    unsigned pixel_ctr_w = 0;
+    for(char chiffre : string)
+        pixel_ctr_w += getCharWidth(chiffre, fontsize, color);
 
-    // now lets draw the chiffres
-    auto chiffre = string.begin();
-    while(chiffre != string.end())
+    // in case of right or middle alignment the text is moved left
+    if(align == ALIGN_MIDDLE || align == ALIGN_RIGHT)
     {
-        const auto charW = getCharWidth(*chiffre, fontsize, color);
-        // if we only count pixels in this round
-        if(pixel_count_loop)
-        {
-            pixel_ctr_w += charW;
-
-            // if text is to long to go further left, stop loop and begin writing at x=0
-            if((align == ALIGN_MIDDLE && pixel_ctr_w / 2 > x) || static_cast<int>(pixel_ctr_w) >= Surf_Dest->w)
-            {
-                pos_x = 0;
-                chiffre = string.begin();
-                pixel_count_loop = false;
-                continue;
-            }
-
-            ++chiffre;
-
-            // if this was the last chiffre go in normal mode and write the text to the specified position
-            if(chiffre == string.end())
-            {
-                chiffre = string.begin();
+        // if text is to long to go further left, begin writing at x=0
+        if((align == ALIGN_MIDDLE && pixel_ctr_w / 2 > x) || static_cast<int>(pixel_ctr_w) >= Surf_Dest->w)
+            pos_x = 0;
+        else if(align == ALIGN_MIDDLE)
+            pos_x = x - pixel_ctr_w / 2;
+        else
+            pos_x = Surf_Dest->w - pixel_ctr_w;
+    }
 
-                if(align == ALIGN_MIDDLE)
-                    pos_x = x - pixel_ctr_w / 2;
-                else if(align == ALIGN_RIGHT)
-                    pos_x = Surf_Dest->w - pixel_ctr_w;
+    // if the whole text fits, blit the cached text run
+    if(static_cast<int>(pos_x + pixel_ctr_w) <= Surf_Dest->w)
+    {
+        if(const TextRun* run = getTextRun(string, fontsize, color))
+            return CSurface::Draw(Surf_Dest, run->surface, pos_x, pos_y);
+    }
 
-                pixel_count_loop = false;
-            }
-            continue;
-        }
+    // now lets draw the chiffres
+    for(char chiffre : string)
+    {
+        const auto charW = getCharWidth(chiffre, fontsize, color);
 
         // if right end of surface is reached, stop drawing chiffres
         if(Surf_Dest->w < static_cast<int>(pos_x + charW))
             break;
 
         // draw the chiffre to the destination
-        CSurface::Draw(Surf_Dest, global::bmpArray[getIndexForChar(*chiffre, fontsize, color)].surface, pos_x, pos_y);
+        CSurface::Draw(Surf_Dest, global::bmpArray[getIndexForChar(chiffre, fontsize, color)].surface, pos_x, pos_y);
 
         // set position for next chiffre
         pos_x += charW;
-
-        // go to next chiffre
-        ++chiffre;
     }
 
     return true;
 }
+
+void CFont::clearCache()
+{
+    for(const TextRun& run : textRuns)
+        SDL_FreeSurface(run.surface);
+    textRuns.clear();
+    textRunIndex.clear();
+    textRunBytes = 0;
+    for(auto& atlas : glyphAtlases)
+        SDL_FreeSurface(atlas.second.surface);
+    glyphAtlases.clear();
+}
@@ -52,8 +52,11 @@ public:
     // fontsize can be 9, 11 or 14 (otherwise it will be set to 9) ---- '\n' is possible
     bool writeText();
     // this function can be used as CFont::writeText to write text directly to a surface without creating an object
+    // the text is composited once from a glyph atlas and cached (least recently used texts are freed first)
     static bool writeText(SDL_Surface* Surf_Dest, const std::string& string, unsigned x = 0, unsigned y = 0, unsigned fontsize = 9,
                           unsigned color = FONT_YELLOW, FontAlign align = ALIGN_LEFT);
+    // frees cached texts and glyph atlases (must be called before the font pictures are freed)
+    static void clearCache();
 };
 
 #endif
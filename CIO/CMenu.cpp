@@ -52,6 +52,14 @@ CMenu::~CMenu()
     SDL_FreeSurface(Surf_Menu);
 }
 
+void CMenu::setWaste()
+{
+    if(waste)
+        return;
+    waste = true;
+    global::s2->AddWaste(this);
+}
+
 void CMenu::setBackgroundPicture(int pic_background)
 {
     this->pic_background = pic_background;
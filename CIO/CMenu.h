@@ -49,7 +49,8 @@ public:
     void setActive() { active = true; };
     void setInactive() { active = false; };
     bool isActive() { return active; };
-    void setWaste() { waste = true; };
+    // the menu is deleted in the next gameloop
+    void setWaste();
     bool isWaste() { return waste; };
     // Methods
     CButton* addButton(void callback(int), int clickedParam, Uint16 x = 0, Uint16 y = 0, Uint16 w = 20, Uint16 h = 20,
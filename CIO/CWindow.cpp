@@ -85,6 +85,14 @@ CWindow::~CWindow()
     SDL_FreeSurface(Surf_Window);
 }
 
+void CWindow::setWaste()
+{
+    if(waste)
+        return;
+    waste = true;
+    global::s2->AddWaste(this);
+}
+
 void CWindow::setTitle(const char* title)
 {
     this->title = title;
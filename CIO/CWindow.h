@@ -86,7 +86,8 @@ public:
     }
     void setInactive();
     bool isActive() const { return active; }
-    void setWaste() { waste = true; }
+    // the window is deleted in the next gameloop
+    void setWaste();
     bool isWaste() const { return waste; }
     bool isMoving() const { return moving; }
     bool isResizing() const { return resizing; }
@@ -1,14 +1,67 @@
 #include "CMap.h"
 #include "CGame.h"
+#include "CHexGrid.h"
 #include "CIO/CFile.h"
 #include "CIO/CFont.h"
+#include "CProfiler.h"
 #include "CSurface.h"
 #include "callbacks.h"
 #include "globals.h"
 #include "gameData/LandscapeDesc.h"
 #include "gameData/TerrainDesc.h"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+// recalculateMap() hands out the rows to its threads in bands of this height
+const int RECALCULATE_BAND_HEIGHT = 16;
+// rows relit each frame after setLight() in preview mode
+const int RELIGHT_ROWS_PER_FRAME = 32;
+
+// adds the lit minimap colors (clamped to 0 - 255) of count vertices to the sums of their columns
+void addLitColors(const MapNode* vertex, const std::array<Uint32, 0x40>& colors, int* rSum, int* gSum, int* bSum, int count)
+{
+    int x = 0;
+#ifdef S25EDIT_USE_SSE2
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi16(255);
+    for(; x + 4 <= count; x += 4)
+    {
+        // the colors are looked up per vertex, the light is split into the integer part hi and the fraction lo
+        const __m128i color = _mm_set_epi32(colors[vertex[x + 3].rsuTexture & 0x3F], colors[vertex[x + 2].rsuTexture & 0x3F],
+                                            colors[vertex[x + 1].rsuTexture & 0x3F], colors[vertex[x].rsuTexture & 0x3F]);
+        const __m128i light = _mm_set_epi32(vertex[x + 3].i, vertex[x + 2].i, vertex[x + 1].i, vertex[x].i);
+        const __m128i hi = _mm_srai_epi32(light, 16);
+        const __m128i lo = _mm_and_si128(light, _mm_set1_epi32(0xFFFF));
+        // channel * light >> 16 = channel * hi + (channel * lo >> 16), both fit in 16 bit multiplications
+        auto addChannel = [&](int shift, int* sum) {
+            const __m128i channel = _mm_and_si128(_mm_srli_epi32(color, shift), byteMask);
+            const __m128i value = _mm_add_epi32(_mm_madd_epi16(channel, hi), _mm_mulhi_epu16(channel, lo));
+            const __m128i clamped = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(value, value), zero), max);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(sum + x),
+                             _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sum + x)), _mm_unpacklo_epi16(clamped, zero)));
+        };
+        addChannel(16, rSum);
+        addChannel(8, gSum);
+        addChannel(0, bSum);
+    }
+#endif
+    for(; x < count; x++)
+    {
+        // mask out the harbor bit
+        const Uint32 color = colors[vertex[x].rsuTexture & 0x3F];
+        const Sint32 light = vertex[x].i;
+        rSum[x] += std::min(std::max(static_cast<Sint32>(color >> 16) * light >> 16, 0), 255);
+        gSum[x] += std::min(std::max(static_cast<Sint32>((color >> 8) & 0xFF) * light >> 16, 0), 255);
+        bSum[x] += std::min(std::max(static_cast<Sint32>(color & 0xFF) * light >> 16, 0), 255);
+    }
+}
+} // namespace
 
 void bobMAP::setName(const std::string& newName)
 {
@@ -23,6 +76,18 @@ void bobMAP::setAuthor(const std::string& newAuthor)
         author.resize(20);
 }
 
+void bobMAP::resizeVertices()
+{
+    const size_t size = static_cast<size_t>(width) * height;
+    vertex.resize(size);
+    flatVectors.resize(size);
+    normVectors.resize(size);
+    unknown1.resize(size);
+    unknown2.resize(size);
+    unknown3.resize(size);
+    unknown5.resize(size);
+}
+
 void bobMAP::initVertexCoords()
 {
     for(unsigned j = 0; j < height; j++)
@@ -41,26 +106,12 @@ void bobMAP::updateVertexCoords()
 {
     width_pixel = width * TRIANGLE_WIDTH;
     height_pixel = height * TRIANGLE_HEIGHT;
+}
 
-    Sint32 b = 0;
-    for(unsigned j = 0; j < height; j++)
-    {
-        Sint32 a;
-        if(j % 2u == 0u)
-            a = TRIANGLE_WIDTH / 2u;
-        else
-            a = TRIANGLE_WIDTH;
-
-        for(unsigned i = 0; i < width; i++)
-        {
-            MapNode& curVertex = getVertex(i, j);
-            curVertex.x = a;
-            curVertex.y = b - TRIANGLE_INCREASE * (curVertex.h - 0x0A);
-            curVertex.z = TRIANGLE_INCREASE * (curVertex.h - 0x0A);
-            a += TRIANGLE_WIDTH;
-        }
-        b += TRIANGLE_HEIGHT;
-    }
+size_t bobMAP::getMemoryUsage() const
+{
+    return vertex.capacity() * sizeof(MapNode) + (flatVectors.capacity() + normVectors.capacity()) * sizeof(vector)
+           + unknown1.capacity() + unknown2.capacity() + unknown3.capacity() + unknown5.capacity();
 }
 
 CMap::CMap(const std::string& filename)
@@ -76,9 +127,17 @@ CMap::~CMap()
 void CMap::constructMap(const std::string& filename, int width, int height, MapType type, TriangleTerrainType texture, int border,
                         int border_texture)
 {
+    CTrace::Scope traceScope("constructMap", "io", filename);
+
     map = nullptr;
     Surf_Map = nullptr;
     Surf_RightMenubar = nullptr;
+    Surf_Chrome = nullptr;
+    Surf_Minimap = nullptr;
+    minimapDirtyRows_.clear();
+    minimapDirty_ = true;
+    lod_.invalidate();
+    lodLevel_ = 0;
     displayRect.left = 0;
     displayRect.top = 0;
     displayRect.setSize(global::s2->GameResolution);
@@ -93,18 +152,8 @@ void CMap::constructMap(const std::string& filename, int width, int height, MapT
     // load the right MAP0x.LST for all pictures
     loadMapPics();
 
-    CSurface::get_nodeVectors(*map);
-
     // for safety recalculate build and shadow data and test if fishes and water is correct
-    for(int i = 0; i < map->height; i++)
-    {
-        for(int j = 0; j < map->width; j++)
-        {
-            modifyBuild(j, i);
-            modifyShading(j, i);
-            modifyResource(j, i);
-        }
-    }
+    recalculateMap();
 
     needSurface = true;
     active = true;
@@ -219,6 +268,12 @@ void CMap::destructMap()
     // free the surface of the right menubar
     SDL_FreeSurface(Surf_RightMenubar);
     Surf_RightMenubar = nullptr;
+    // free the chrome overlay
+    SDL_FreeSurface(Surf_Chrome);
+    Surf_Chrome = nullptr;
+    // free the minimap
+    SDL_FreeSurface(Surf_Minimap);
+    Surf_Minimap = nullptr;
     // free vertex array
     Vertices.clear();
     // free map structure memory
@@ -243,7 +298,12 @@ bobMAP* CMap::generateMap(int width, int height, MapType type, TriangleTerrainTy
         myMap->HQy[i] = 0xFFFF;
     }
 
-    myMap->vertex.resize(myMap->width * myMap->height);
+    myMap->resizeVertices();
+    // initialize the blocks that are not stored in the vertices
+    std::fill(myMap->unknown1.begin(), myMap->unknown1.end(), 0x00);
+    std::fill(myMap->unknown2.begin(), myMap->unknown2.end(), 0x07);
+    std::fill(myMap->unknown3.begin(), myMap->unknown3.end(), 0x00);
+    std::fill(myMap->unknown5.begin(), myMap->unknown5.end(), 0x00);
 
     for(int j = 0; j < myMap->height; j++)
     {
@@ -267,13 +327,9 @@ bobMAP* CMap::generateMap(int width, int height, MapType type, TriangleTerrainTy
             curVertex.objectType = 0x00;
             curVertex.objectInfo = 0x00;
             curVertex.animal = 0x00;
-            curVertex.unknown1 = 0x00;
             // curVertex.build = 0x00;
-            curVertex.unknown2 = 0x07;
-            curVertex.unknown3 = 0x00;
             // curVertex.resource = 0x00;
             // curVertex.shading = 0x00;
-            curVertex.unknown5 = 0x00;
         }
     }
     myMap->initVertexCoords();
@@ -283,6 +339,7 @@ bobMAP* CMap::generateMap(int width, int height, MapType type, TriangleTerrainTy
 
 void CMap::rotateMap()
 {
+    invalidateOverview();
     // we allocate memory for the new triangle field but with x equals the height and y equals the width
     std::vector<MapNode> new_vertex(map->vertex.size());
 
@@ -301,13 +358,25 @@ void CMap::rotateMap()
     // release old map and point to new
     std::swap(map->vertex, new_vertex);
 
+    // the same for the blocks that are not stored in the vertices (the vectors are calculated again below)
+    for(std::vector<Uint8>* block : {&map->unknown1, &map->unknown2, &map->unknown3, &map->unknown5})
+    {
+        std::vector<Uint8> new_block(block->size());
+        for(int y = 0; y < map->height; y++)
+        {
+            for(int x = 0; x < map->width; x++)
+                new_block[x * map->height + (map->height - 1 - y)] = (*block)[y * map->width + x];
+        }
+        std::swap(*block, new_block);
+    }
+
     // permute width and height
     Uint16 tmp_height = map->height;
     Uint16 tmp_height_old = map->height_old;
-    Uint16 tmp_height_pixel = map->height_pixel;
+    Sint32 tmp_height_pixel = map->height_pixel;
     Uint16 tmp_width = map->width;
     Uint16 tmp_width_old = map->width_old;
-    Uint16 tmp_width_pixel = map->width_pixel;
+    Sint32 tmp_width_pixel = map->width_pixel;
 
     map->height = tmp_width;
     map->height_old = tmp_width_old;
@@ -324,16 +393,7 @@ void CMap::rotateMap()
 
     // recalculate some values
     map->initVertexCoords();
-    for(int y = 0; y < map->height; y++)
-    {
-        for(int x = 0; x < map->width; x++)
-        {
-            modifyBuild(x, y);
-            modifyShading(x, y);
-            modifyResource(x, y);
-            CSurface::update_shading(*map, x, y);
-        }
-    }
+    recalculateMap();
 
     // reset mouse and view position to prevent failures
     VertexX_ = 12;
@@ -347,55 +407,46 @@ void CMap::rotateMap()
 
 void CMap::MirrorMapOnXAxis()
 {
+    invalidateOverview();
     for(int y = 1; y < map->height / 2; y++)
     {
         for(int x = 0; x < map->width; x++)
         {
             map->getVertex(x, map->height - y) = map->getVertex(x, y);
+            for(std::vector<Uint8>* block : {&map->unknown1, &map->unknown2, &map->unknown3, &map->unknown5})
+                (*block)[(map->height - y) * map->width + x] = (*block)[y * map->width + x];
         }
     }
 
     // recalculate some values
     map->initVertexCoords();
-    for(int y = 0; y < map->height; y++)
-    {
-        for(int x = 0; x < map->width; x++)
-        {
-            modifyBuild(x, y);
-            modifyShading(x, y);
-            modifyResource(x, y);
-            CSurface::update_shading(*map, x, y);
-        }
-    }
+    recalculateMap();
 }
 
 void CMap::MirrorMapOnYAxis()
 {
+    invalidateOverview();
     for(int y = 0; y < map->height; y++)
     {
         for(int x = 0; x < map->width / 2; x++)
         {
+            int mirroredX;
             if(y % 2 != 0)
             {
-                if(x != map->width / 2 - 1)
-                    map->getVertex(map->width - 2 - x, y) = map->getVertex(x, y);
+                if(x == map->width / 2 - 1)
+                    continue;
+                mirroredX = map->width - 2 - x;
             } else
-                map->getVertex(map->width - 1 - x, y) = map->getVertex(x, y);
+                mirroredX = map->width - 1 - x;
+            map->getVertex(mirroredX, y) = map->getVertex(x, y);
+            for(std::vector<Uint8>* block : {&map->unknown1, &map->unknown2, &map->unknown3, &map->unknown5})
+                (*block)[y * map->width + mirroredX] = (*block)[y * map->width + x];
         }
     }
 
     // recalculate some values
     map->initVertexCoords();
-    for(int y = 0; y < map->height; y++)
-    {
-        for(int x = 0; x < map->width; x++)
-        {
-            modifyBuild(x, y);
-            modifyShading(x, y);
-            modifyResource(x, y);
-            CSurface::update_shading(*map, x, y);
-        }
-    }
+    recalculateMap();
 }
 
 void CMap::loadMapPics()
@@ -478,7 +529,8 @@ void CMap::unloadMapPics()
 
 void CMap::moveMap(Position offset)
 {
-    displayRect.setOrigin(displayRect.getOrigin() + offset);
+    // the offset is given in screen pixels
+    displayRect.setOrigin(displayRect.getOrigin() + offset * CMapLod::getScale(lodLevel_));
     // reset coords of displayRects when end of map is reached
     if(displayRect.left >= map->width_pixel)
         displayRect.move(Position(-map->width_pixel, 0));
@@ -489,6 +541,18 @@ void CMap::moveMap(Position offset)
         displayRect.move(Position(0, -map->height_pixel));
     else if(displayRect.top <= -static_cast<int>(displayRect.getSize().y))
         displayRect.setOrigin(Position(displayRect.left, map->height_pixel - displayRect.getSize().y));
+    // the minimap shows the position of the display
+    global::s2->WakeCallback(callback::MinimapMenu);
+}
+
+void CMap::setLodLevel(int level)
+{
+    level = std::min(std::max(level, 0), CMapLod::MAX_LEVEL);
+    const Position halfSize(displayRect.getSize().x / 2, displayRect.getSize().y / 2);
+    const Position center = displayRect.getOrigin() + halfSize * CMapLod::getScale(lodLevel_);
+    lodLevel_ = level;
+    displayRect.setOrigin(center - halfSize * CMapLod::getScale(lodLevel_));
+    moveMap(Position(0, 0));
 }
 
 void CMap::setMouseData(const SDL_MouseMotionEvent& motion)
@@ -647,18 +711,31 @@ void CMap::setMouseData(const SDL_MouseButtonEvent& button)
         {
             // no picture was clicked
 
+            // in the zoomed out view a click zooms in to the clicked position
+            if(button.button == SDL_BUTTON_LEFT && lodLevel_ > 0)
+            {
+                displayRect.setOrigin(displayRect.getOrigin() + Position(button.x, button.y) * CMapLod::getScale(lodLevel_));
+                lodLevel_ = 0;
+                displayRect.setOrigin(displayRect.getOrigin() - Position(displayRect.getSize().x / 2, displayRect.getSize().y / 2));
+                moveMap(Position(0, 0));
+            }
             // touch vertex data
-            if(button.button == SDL_BUTTON_LEFT)
+            else if(button.button == SDL_BUTTON_LEFT)
             {
                 modify = true;
                 saveCurrentVertices = true;
+                strokeStart_ = CTrace::Clock::now();
             }
         }
     } else if(button.state == SDL_RELEASED)
     {
         // stop touching vertex data
         if(button.button == SDL_BUTTON_LEFT)
+        {
+            if(modify)
+                CTrace::addAsyncEvent("stroke", "edit", strokeStart_, CTrace::Clock::now(), "mode " + std::to_string(mode));
             modify = false;
+        }
     }
 }
 
@@ -687,27 +764,6 @@ SavedVertex saveVertex(Position pt, const bobMAP& map)
     }
     return res;
 }
-
-void restoreVertex(const SavedVertex& vertex, bobMAP& map)
-{
-    for(int i = vertex.pos.x - MAX_CHANGE_SECTION - 10 - 2, k = 0; i <= vertex.pos.x + MAX_CHANGE_SECTION + 10 + 2; i++, k++)
-    {
-        for(int j = vertex.pos.y - MAX_CHANGE_SECTION - 10 - 2, l = 0; j <= vertex.pos.y + MAX_CHANGE_SECTION + 10 + 2; j++, l++)
-        {
-            int m = i;
-            if(m < 0)
-                m += map.width;
-            else if(m >= map.width)
-                m -= map.width;
-            int n = j;
-            if(n < 0)
-                n += map.height;
-            else if(n >= map.height)
-                n -= map.height;
-            map.getVertex(m, n) = vertex.PointsArroundVertex[l][k];
-        }
-    }
-}
 } // namespace
 
 void CMap::setKeyboardData(const SDL_KeyboardEvent& key)
@@ -876,16 +932,25 @@ void CMap::setKeyboardData(const SDL_KeyboardEvent& key)
                     {
                         if(!redoBuffer.empty())
                         {
+                            CTrace::Scope traceScope("redo", "edit");
                             undoBuffer.push_back(saveVertex(redoBuffer.back().pos, *map));
-                            restoreVertex(redoBuffer.back(), *map);
+                            restoreVertex(redoBuffer.back());
+                            updateDirtyVertices();
+                            markRowsChanged(redoBuffer.back().pos.y - MAX_CHANGE_SECTION - 12,
+                                            redoBuffer.back().pos.y + MAX_CHANGE_SECTION + 12);
                             redoBuffer.pop_back();
                         }
                     } else if(!undoBuffer.empty())
                     {
+                        CTrace::Scope traceScope("undo", "edit");
                         redoBuffer.push_back(saveVertex(undoBuffer.back().pos, *map));
-                        restoreVertex(undoBuffer.back(), *map);
+                        restoreVertex(undoBuffer.back());
+                        updateDirtyVertices();
+                        markRowsChanged(undoBuffer.back().pos.y - MAX_CHANGE_SECTION - 12,
+                                        undoBuffer.back().pos.y + MAX_CHANGE_SECTION + 12);
                         undoBuffer.pop_back();
                     }
+                    global::s2->WakeCallback(callback::MinimapMenu);
                 }
                 break;
             case SDLK_UP:
@@ -917,6 +982,7 @@ void CMap::setKeyboardData(const SDL_KeyboardEvent& key)
                 map->type = MAP_GREENLAND;
                 unloadMapPics();
                 loadMapPics();
+                invalidateOverview();
 
                 callback::PleaseWait(WINDOW_QUIT_MESSAGE);
                 break;
@@ -936,6 +1002,7 @@ void CMap::setKeyboardData(const SDL_KeyboardEvent& key)
                 map->type = MAP_WASTELAND;
                 unloadMapPics();
                 loadMapPics();
+                invalidateOverview();
 
                 break;
             case SDLK_w: // convert map to winterland
@@ -954,6 +1021,7 @@ void CMap::setKeyboardData(const SDL_KeyboardEvent& key)
                 map->type = MAP_WINTERLAND;
                 unloadMapPics();
                 loadMapPics();
+                invalidateOverview();
 
                 callback::PleaseWait(WINDOW_QUIT_MESSAGE);
                 break;
@@ -963,6 +1031,9 @@ void CMap::setKeyboardData(const SDL_KeyboardEvent& key)
                 else
                     setBitsPerPixel(8);
                 break;
+            case SDLK_F8: // zoom out to 1/4, 1/16, 1/64 and back to the normal view
+                setLodLevel((lodLevel_ + 1) % (CMapLod::MAX_LEVEL + 1));
+                break;
             case SDLK_F9: // lock horizontal movement
                 HorizontalMovementLocked = !HorizontalMovementLocked;
 
@@ -1043,7 +1114,7 @@ void CMap::storeVerticesFromMouse(Uint16 MouseX, Uint16 MouseY, Uint8 /*MouseSta
         if(j % 2 == 0)
         {
             // subtract "TRIANGLE_HEIGHT/2" is for tolerance, we did the same for X
-            if((MousePosY - TRIANGLE_HEIGHT / 2) > map->getVertex(Xeven, j).y)
+            if((MousePosY - TRIANGLE_HEIGHT / 2) > map->getVertex(Xeven, j).getY())
                 Y++;
             else
             {
@@ -1052,7 +1123,7 @@ void CMap::storeVerticesFromMouse(Uint16 MouseX, Uint16 MouseY, Uint8 /*MouseSta
             }
         } else
         {
-            if((MousePosY - TRIANGLE_HEIGHT / 2) > map->getVertex(Xodd, j).y)
+            if((MousePosY - TRIANGLE_HEIGHT / 2) > map->getVertex(Xodd, j).getY())
                 Y++;
             else
             {
@@ -1078,7 +1149,7 @@ void CMap::storeVerticesFromMouse(Uint16 MouseX, Uint16 MouseY, Uint8 /*MouseSta
 
 int CMap::correctMouseBlitX(int VertexX, int VertexY)
 {
-    int newBlitx = map->getVertex(VertexX, VertexY).x;
+    int newBlitx = map->getVertex(VertexX, VertexY).getX();
     if(newBlitx < displayRect.left)
         newBlitx += map->width_pixel;
     else if(newBlitx > displayRect.right)
@@ -1089,7 +1160,7 @@ int CMap::correctMouseBlitX(int VertexX, int VertexY)
 }
 int CMap::correctMouseBlitY(int VertexX, int VertexY)
 {
-    int newBlity = map->getVertex(VertexX, VertexY).y;
+    int newBlity = map->getVertex(VertexX, VertexY).getY();
     if(newBlity < displayRect.top)
         newBlity += map->height_pixel;
     else if(newBlity > displayRect.bottom)
@@ -1101,8 +1172,32 @@ int CMap::correctMouseBlitY(int VertexX, int VertexY)
 
 void CMap::render()
 {
-    std::array<char, 100> textBuffer;
+    if(prepareRender())
+        drawMap(Surf_Map);
+}
+
+void CMap::renderTo(SDL_Surface* display)
+{
+    if(!prepareRender())
+        return;
+    const SDL_PixelFormat& mapFormat = *Surf_Map->format;
+    const SDL_PixelFormat& displayFormat = *display->format;
+    // 8 bit maps have an own palette, so they are always converted by the blit
+    if(display->w == Surf_Map->w && display->h == Surf_Map->h && !SDL_MUSTLOCK(display) && mapFormat.BitsPerPixel != 8
+       && displayFormat.BitsPerPixel == mapFormat.BitsPerPixel && displayFormat.Rmask == mapFormat.Rmask
+       && displayFormat.Gmask == mapFormat.Gmask && displayFormat.Bmask == mapFormat.Bmask)
+        drawMap(display);
+    else
+    {
+        drawMap(Surf_Map);
+        // copying the map to the display is part of the composition
+        CProfiler::Scope scope(PROFILE_COMPOSITION);
+        CSurface::Draw(display, Surf_Map, 0, 0);
+    }
+}
 
+bool CMap::prepareRender()
+{
     // check if gameresolution has been changed
     if(displayRect.getSize() != global::s2->GameResolution)
     {
@@ -1113,24 +1208,56 @@ void CMap::render()
     // if we need a new surface
     if(needSurface)
     {
+        // the chrome overlay depends on size and bpp of the map surface
+        SDL_FreeSurface(Surf_Chrome);
+        Surf_Chrome = nullptr;
         SDL_FreeSurface(Surf_Map);
         Surf_Map = SDL_CreateRGBSurface(SDL_SWSURFACE, displayRect.getSize().x, displayRect.getSize().y, BitsPerPixel, 0, 0, 0, 0);
         if(Surf_Map == nullptr)
-            return;
+            return false;
         if(BitsPerPixel == 8)
             SDL_SetPalette(Surf_Map, SDL_LOGPAL, global::palArray[PAL_xBBM].colors.data(), 0, global::palArray[PAL_xBBM].colors.size());
+        // the chrome only changes with the surface, so it is composited once and blitted each frame
+        Surf_Chrome = createChromeOverlay();
         needSurface = false;
     }
     // else
     // clear the surface before drawing new (in normal case not needed)
     // SDL_FillRect( Surf_Map, nullptr, SDL_MapRGB(Surf_Map->format,0,0,0) );
 
+    if(relightRowsLeft_ > 0)
+    {
+        const int rows = std::min(relightRowsLeft_, RELIGHT_ROWS_PER_FRAME);
+        CSurface::relight(*map, relightNextRow_, relightNextRow_ + rows - 1);
+        markRowsChanged(relightNextRow_, relightNextRow_ + rows - 1);
+        relightNextRow_ += rows;
+        relightRowsLeft_ -= rows;
+        // the remaining rows must not wait for the idle frame
+        if(relightRowsLeft_ > 0)
+            global::s2->requestFrame();
+    }
+
     // touch vertex data if user modifies it
     if(modify)
         modifyVertex();
+    return true;
+}
 
-    if(!map->vertex.empty())
-        CSurface::DrawTriangleField(Surf_Map, displayRect, *map);
+void CMap::drawMap(SDL_Surface* surface)
+{
+    std::array<char, 100> textBuffer;
+
+    if(lodLevel_ > 0)
+    {
+        if(!map->vertex.empty())
+            lod_.render(surface, displayRect, *map, lodLevel_);
+        // the zoomed out view is not animated
+        CSurface::drawnAnimatedTextures = false;
+        CSurface::drawnAnimatedObjects = false;
+    } else if(!map->vertex.empty())
+        CSurface::DrawTriangleField(surface, displayRect, *map);
+
+    CProfiler::Scope scope(PROFILE_CHROME);
 
     // draw pictures to cursor position
     int symbol_index, symbol_index2 = -1;
@@ -1155,117 +1282,132 @@ void CMap::render()
         case EDITOR_MODE_ANIMAL: symbol_index = CURSOR_SYMBOL_ANIMAL; break;
         default: symbol_index = CURSOR_SYMBOL_ARROW_UP; break;
     }
-    for(int i = 0; i < VertexCounter; i++)
+    for(int i = 0; i < VertexCounter && lodLevel_ == 0; i++)
     {
         if(Vertices[i].active)
         {
-            CSurface::Draw(Surf_Map, global::bmpArray[symbol_index].surface, Vertices[i].blit_x - 10, Vertices[i].blit_y - 10);
+            CSurface::Draw(surface, global::bmpArray[symbol_index].surface, Vertices[i].blit_x - 10, Vertices[i].blit_y - 10);
             if(symbol_index2 >= 0)
-                CSurface::Draw(Surf_Map, global::bmpArray[symbol_index2].surface, Vertices[i].blit_x, Vertices[i].blit_y - 7);
+                CSurface::Draw(surface, global::bmpArray[symbol_index2].surface, Vertices[i].blit_x, Vertices[i].blit_y - 7);
         }
     }
 
     // text for x and y of vertex (shown in upper left corner)
     sprintf(textBuffer.data(), "%d    %d", VertexX_, VertexY_);
-    CFont::writeText(Surf_Map, textBuffer.data(), 20, 20);
+    CFont::writeText(surface, textBuffer.data(), 20, 20);
     // text for MinReduceHeight and MaxRaiseHeight
     sprintf(textBuffer.data(), "min. height: %#04x/0x3C  max. height: %#04x/0x3C  NormalNull: 0x0A", MinReduceHeight, MaxRaiseHeight);
-    CFont::writeText(Surf_Map, textBuffer.data(), 100, 20);
+    CFont::writeText(surface, textBuffer.data(), 100, 20);
     // text for MovementLocked
     if(HorizontalMovementLocked && VerticalMovementLocked)
-        CFont::writeText(Surf_Map, "Movement locked (F9 or F10 to unlock)", 20, 40, 14, FONT_ORANGE);
+        CFont::writeText(surface, "Movement locked (F9 or F10 to unlock)", 20, 40, 14, FONT_ORANGE);
     else if(HorizontalMovementLocked)
-        CFont::writeText(Surf_Map, "Horizontal movement locked (F9 to unlock)", 20, 40, 14, FONT_ORANGE);
+        CFont::writeText(surface, "Horizontal movement locked (F9 to unlock)", 20, 40, 14, FONT_ORANGE);
     else if(VerticalMovementLocked)
-        CFont::writeText(Surf_Map, "Vertikal movement locked (F10 to unlock)", 20, 40, 14, FONT_ORANGE);
+        CFont::writeText(surface, "Vertikal movement locked (F10 to unlock)", 20, 40, 14, FONT_ORANGE);
+    // text for the zoomed out view
+    if(lodLevel_ > 0)
+    {
+        sprintf(textBuffer.data(), "Zoomed out 1/%d (F8 to zoom, click to edit)", CMapLod::getScale(lodLevel_));
+        CFont::writeText(surface, textBuffer.data(), 20, 60, 14, FONT_ORANGE);
+    }
 
+    // draw the frame, statues and menubars
+    if(Surf_Chrome)
+        CSurface::Draw(surface, Surf_Chrome, 0, 0);
+    else
+        drawChrome(surface);
+}
+
+void CMap::drawChrome(SDL_Surface* surface)
+{
     // draw the frame
     if(displayRect.getSize() == Extent(640, 480))
-        CSurface::Draw(Surf_Map, global::bmpArray[MAINFRAME_640_480].surface, 0, 0);
+        CSurface::Draw(surface, global::bmpArray[MAINFRAME_640_480].surface, 0, 0);
     else if(displayRect.getSize() == Extent(800, 600))
-        CSurface::Draw(Surf_Map, global::bmpArray[MAINFRAME_800_600].surface, 0, 0);
+        CSurface::Draw(surface, global::bmpArray[MAINFRAME_800_600].surface, 0, 0);
     else if(displayRect.getSize() == Extent(1024, 768))
-        CSurface::Draw(Surf_Map, global::bmpArray[MAINFRAME_1024_768].surface, 0, 0);
+        CSurface::Draw(surface, global::bmpArray[MAINFRAME_1024_768].surface, 0, 0);
     else if(displayRect.getSize() == Extent(1280, 1024))
     {
-        CSurface::Draw(Surf_Map, global::bmpArray[MAINFRAME_LEFT_1280_1024].surface, 0, 0);
-        CSurface::Draw(Surf_Map, global::bmpArray[MAINFRAME_RIGHT_1280_1024].surface, 640, 0);
+        CSurface::Draw(surface, global::bmpArray[MAINFRAME_LEFT_1280_1024].surface, 0, 0);
+        CSurface::Draw(surface, global::bmpArray[MAINFRAME_RIGHT_1280_1024].surface, 640, 0);
     } else
     {
         // draw the corners
-        CSurface::Draw(Surf_Map, global::bmpArray[MAINFRAME_640_480].surface, 0, 0, 0, 0, 150, 150);
-        CSurface::Draw(Surf_Map, global::bmpArray[MAINFRAME_640_480].surface, 0, displayRect.getSize().y - 150, 0, 480 - 150, 150, 150);
-        CSurface::Draw(Surf_Map, global::bmpArray[MAINFRAME_640_480].surface, displayRect.getSize().x - 150, 0, 640 - 150, 0, 150, 150);
-        CSurface::Draw(Surf_Map, global::bmpArray[MAINFRAME_640_480].surface, displayRect.getSize().x - 150, displayRect.getSize().y - 150,
+        CSurface::Draw(surface, global::bmpArray[MAINFRAME_640_480].surface, 0, 0, 0, 0, 150, 150);
+        CSurface::Draw(surface, global::bmpArray[MAINFRAME_640_480].surface, 0, displayRect.getSize().y - 150, 0, 480 - 150, 150, 150);
+        CSurface::Draw(surface, global::bmpArray[MAINFRAME_640_480].surface, displayRect.getSize().x - 150, 0, 640 - 150, 0, 150, 150);
+        CSurface::Draw(surface, global::bmpArray[MAINFRAME_640_480].surface, displayRect.getSize().x - 150, displayRect.getSize().y - 150,
                        640 - 150, 480 - 150, 150, 150);
         // draw the edges
         unsigned x = 150, y = 150;
         while(x + 150 < displayRect.getSize().x)
         {
-            CSurface::Draw(Surf_Map, global::bmpArray[MAINFRAME_640_480].surface, x, 0, 150, 0, 150, 12);
-            CSurface::Draw(Surf_Map, global::bmpArray[MAINFRAME_640_480].surface, x, displayRect.getSize().y - 12, 150, 0, 150, 12);
+            CSurface::Draw(surface, global::bmpArray[MAINFRAME_640_480].surface, x, 0, 150, 0, 150, 12);
+            CSurface::Draw(surface, global::bmpArray[MAINFRAME_640_480].surface, x, displayRect.getSize().y - 12, 150, 0, 150, 12);
             x += 150;
         }
         while(y + 150 < displayRect.getSize().y)
         {
-            CSurface::Draw(Surf_Map, global::bmpArray[MAINFRAME_640_480].surface, 0, y, 0, 150, 12, 150);
-            CSurface::Draw(Surf_Map, global::bmpArray[MAINFRAME_640_480].surface, displayRect.getSize().x - 12, y, 0, 150, 12, 150);
+            CSurface::Draw(surface, global::bmpArray[MAINFRAME_640_480].surface, 0, y, 0, 150, 12, 150);
+            CSurface::Draw(surface, global::bmpArray[MAINFRAME_640_480].surface, displayRect.getSize().x - 12, y, 0, 150, 12, 150);
             y += 150;
         }
     }
 
     // draw the statues at the frame
-    CSurface::Draw(Surf_Map, global::bmpArray[STATUE_UP_LEFT].surface, 12, 12);
-    CSurface::Draw(Surf_Map, global::bmpArray[STATUE_UP_RIGHT].surface, displayRect.getSize().x - global::bmpArray[STATUE_UP_RIGHT].w - 12,
+    CSurface::Draw(surface, global::bmpArray[STATUE_UP_LEFT].surface, 12, 12);
+    CSurface::Draw(surface, global::bmpArray[STATUE_UP_RIGHT].surface, displayRect.getSize().x - global::bmpArray[STATUE_UP_RIGHT].w - 12,
                    12);
-    CSurface::Draw(Surf_Map, global::bmpArray[STATUE_DOWN_LEFT].surface, 12,
+    CSurface::Draw(surface, global::bmpArray[STATUE_DOWN_LEFT].surface, 12,
                    displayRect.getSize().y - global::bmpArray[STATUE_DOWN_LEFT].h - 12);
-    CSurface::Draw(Surf_Map, global::bmpArray[STATUE_DOWN_RIGHT].surface,
+    CSurface::Draw(surface, global::bmpArray[STATUE_DOWN_RIGHT].surface,
                    displayRect.getSize().x - global::bmpArray[STATUE_DOWN_RIGHT].w - 12,
                    displayRect.getSize().y - global::bmpArray[STATUE_DOWN_RIGHT].h - 12);
 
     // lower menubar
     // draw lower menubar
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR].surface, displayRect.getSize().x / 2 - global::bmpArray[MENUBAR].w / 2,
+    CSurface::Draw(surface, global::bmpArray[MENUBAR].surface, displayRect.getSize().x / 2 - global::bmpArray[MENUBAR].w / 2,
                    displayRect.getSize().y - global::bmpArray[MENUBAR].h);
 
     // draw pictures to lower menubar
     // backgrounds
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 236, displayRect.getSize().y - 36,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 236, displayRect.getSize().y - 36,
                    0, 0, 37, 32);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 199, displayRect.getSize().y - 36,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 199, displayRect.getSize().y - 36,
                    0, 0, 37, 32);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 162, displayRect.getSize().y - 36,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 162, displayRect.getSize().y - 36,
                    0, 0, 37, 32);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 125, displayRect.getSize().y - 36,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 125, displayRect.getSize().y - 36,
                    0, 0, 37, 32);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 88, displayRect.getSize().y - 36,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 88, displayRect.getSize().y - 36,
                    0, 0, 37, 32);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 51, displayRect.getSize().y - 36,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 51, displayRect.getSize().y - 36,
                    0, 0, 37, 32);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 14, displayRect.getSize().y - 36,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 - 14, displayRect.getSize().y - 36,
                    0, 0, 37, 32);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 + 92, displayRect.getSize().y - 36,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 + 92, displayRect.getSize().y - 36,
                    0, 0, 37, 32);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 + 129, displayRect.getSize().y - 36,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 + 129, displayRect.getSize().y - 36,
                    0, 0, 37, 32);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 + 166, displayRect.getSize().y - 36,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 + 166, displayRect.getSize().y - 36,
                    0, 0, 37, 32);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 + 203, displayRect.getSize().y - 36,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x / 2 + 203, displayRect.getSize().y - 36,
                    0, 0, 37, 32);
     // pictures
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR_HEIGHT].surface, displayRect.getSize().x / 2 - 232, displayRect.getSize().y - 35);
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR_TEXTURE].surface, displayRect.getSize().x / 2 - 195, displayRect.getSize().y - 35);
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR_TREE].surface, displayRect.getSize().x / 2 - 158, displayRect.getSize().y - 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR_RESOURCE].surface, displayRect.getSize().x / 2 - 121, displayRect.getSize().y - 32);
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR_LANDSCAPE].surface, displayRect.getSize().x / 2 - 84, displayRect.getSize().y - 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR_ANIMAL].surface, displayRect.getSize().x / 2 - 48, displayRect.getSize().y - 36);
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR_PLAYER].surface, displayRect.getSize().x / 2 - 10, displayRect.getSize().y - 34);
-
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR_BUILDHELP].surface, displayRect.getSize().x / 2 + 96, displayRect.getSize().y - 35);
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR_MINIMAP].surface, displayRect.getSize().x / 2 + 131, displayRect.getSize().y - 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR_NEWWORLD].surface, displayRect.getSize().x / 2 + 166, displayRect.getSize().y - 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR_COMPUTER].surface, displayRect.getSize().x / 2 + 207, displayRect.getSize().y - 35);
+    CSurface::Draw(surface, global::bmpArray[MENUBAR_HEIGHT].surface, displayRect.getSize().x / 2 - 232, displayRect.getSize().y - 35);
+    CSurface::Draw(surface, global::bmpArray[MENUBAR_TEXTURE].surface, displayRect.getSize().x / 2 - 195, displayRect.getSize().y - 35);
+    CSurface::Draw(surface, global::bmpArray[MENUBAR_TREE].surface, displayRect.getSize().x / 2 - 158, displayRect.getSize().y - 37);
+    CSurface::Draw(surface, global::bmpArray[MENUBAR_RESOURCE].surface, displayRect.getSize().x / 2 - 121, displayRect.getSize().y - 32);
+    CSurface::Draw(surface, global::bmpArray[MENUBAR_LANDSCAPE].surface, displayRect.getSize().x / 2 - 84, displayRect.getSize().y - 37);
+    CSurface::Draw(surface, global::bmpArray[MENUBAR_ANIMAL].surface, displayRect.getSize().x / 2 - 48, displayRect.getSize().y - 36);
+    CSurface::Draw(surface, global::bmpArray[MENUBAR_PLAYER].surface, displayRect.getSize().x / 2 - 10, displayRect.getSize().y - 34);
+
+    CSurface::Draw(surface, global::bmpArray[MENUBAR_BUILDHELP].surface, displayRect.getSize().x / 2 + 96, displayRect.getSize().y - 35);
+    CSurface::Draw(surface, global::bmpArray[MENUBAR_MINIMAP].surface, displayRect.getSize().x / 2 + 131, displayRect.getSize().y - 37);
+    CSurface::Draw(surface, global::bmpArray[MENUBAR_NEWWORLD].surface, displayRect.getSize().x / 2 + 166, displayRect.getSize().y - 37);
+    CSurface::Draw(surface, global::bmpArray[MENUBAR_COMPUTER].surface, displayRect.getSize().x / 2 + 207, displayRect.getSize().y - 35);
 
     // right menubar
     // do we need a surface?
@@ -1283,51 +1425,119 @@ void CMap::render()
         }
     }
     // draw right menubar (remember permutation of width and height)
-    CSurface::Draw(Surf_Map, Surf_RightMenubar, displayRect.getSize().x - global::bmpArray[MENUBAR].h,
+    CSurface::Draw(surface, Surf_RightMenubar, displayRect.getSize().x - global::bmpArray[MENUBAR].h,
                    displayRect.getSize().y / 2 - global::bmpArray[MENUBAR].w / 2);
 
     // draw pictures to right menubar
     // backgrounds
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 - 239,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 - 239,
                    0, 0, 32, 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 - 202,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 - 202,
                    0, 0, 32, 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 - 165,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 - 165,
                    0, 0, 32, 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 - 128,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 - 128,
                    0, 0, 32, 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 - 22,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 - 22,
                    0, 0, 32, 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 + 15,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 + 15,
                    0, 0, 32, 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 + 52,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 + 52,
                    0, 0, 32, 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 + 89,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 + 89,
                    0, 0, 32, 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 + 126,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 + 126,
                    0, 0, 32, 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 + 163,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 + 163,
                    0, 0, 32, 37);
-    CSurface::Draw(Surf_Map, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 + 200,
+    CSurface::Draw(surface, global::bmpArray[BUTTON_GREEN1_DARK].surface, displayRect.getSize().x - 36, displayRect.getSize().y / 2 + 200,
                    0, 0, 32, 37);
     // pictures
     // four cursor menu pictures
-    CSurface::Draw(Surf_Map, global::bmpArray[CURSOR_SYMBOL_ARROW_UP].surface, displayRect.getSize().x - 33,
+    CSurface::Draw(surface, global::bmpArray[CURSOR_SYMBOL_ARROW_UP].surface, displayRect.getSize().x - 33,
                    displayRect.getSize().y / 2 - 237);
-    CSurface::Draw(Surf_Map, global::bmpArray[CURSOR_SYMBOL_ARROW_DOWN].surface, displayRect.getSize().x - 20,
+    CSurface::Draw(surface, global::bmpArray[CURSOR_SYMBOL_ARROW_DOWN].surface, displayRect.getSize().x - 20,
                    displayRect.getSize().y / 2 - 235);
-    CSurface::Draw(Surf_Map, global::bmpArray[CURSOR_SYMBOL_ARROW_DOWN].surface, displayRect.getSize().x - 33,
+    CSurface::Draw(surface, global::bmpArray[CURSOR_SYMBOL_ARROW_DOWN].surface, displayRect.getSize().x - 33,
                    displayRect.getSize().y / 2 - 220);
-    CSurface::Draw(Surf_Map, global::bmpArray[CURSOR_SYMBOL_ARROW_UP].surface, displayRect.getSize().x - 20,
+    CSurface::Draw(surface, global::bmpArray[CURSOR_SYMBOL_ARROW_UP].surface, displayRect.getSize().x - 20,
                    displayRect.getSize().y / 2 - 220);
     // bugkill picture for quickload with text
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR_BUGKILL].surface, displayRect.getSize().x - 37, displayRect.getSize().y / 2 + 162);
-    CFont::writeText(Surf_Map, "Load", displayRect.getSize().x - 35, displayRect.getSize().y / 2 + 193);
+    CSurface::Draw(surface, global::bmpArray[MENUBAR_BUGKILL].surface, displayRect.getSize().x - 37, displayRect.getSize().y / 2 + 162);
+    CFont::writeText(surface, "Load", displayRect.getSize().x - 35, displayRect.getSize().y / 2 + 193);
     // bugkill picture for quicksave with text
-    CSurface::Draw(Surf_Map, global::bmpArray[MENUBAR_BUGKILL].surface, displayRect.getSize().x - 37, displayRect.getSize().y / 2 + 200);
-    CFont::writeText(Surf_Map, "Save", displayRect.getSize().x - 35, displayRect.getSize().y / 2 + 231);
+    CSurface::Draw(surface, global::bmpArray[MENUBAR_BUGKILL].surface, displayRect.getSize().x - 37, displayRect.getSize().y / 2 + 200);
+    CFont::writeText(surface, "Save", displayRect.getSize().x - 35, displayRect.getSize().y / 2 + 231);
 }
 
+SDL_Surface* CMap::createChromeOverlay()
+{
+    // the chrome is drawn on two surfaces with different backgrounds, pixels that differ are not covered by the chrome
+    std::array<SDL_Surface*, 2> surfaces;
+    for(unsigned i = 0; i < surfaces.size(); i++)
+    {
+        surfaces[i] = SDL_CreateRGBSurface(SDL_SWSURFACE, Surf_Map->w, Surf_Map->h, Surf_Map->format->BitsPerPixel, Surf_Map->format->Rmask,
+                                           Surf_Map->format->Gmask, Surf_Map->format->Bmask, 0);
+        if(!surfaces[i])
+        {
+            SDL_FreeSurface(surfaces[0]);
+            return nullptr;
+        }
+        if(Surf_Map->format->palette)
+            SDL_SetPalette(surfaces[i], SDL_LOGPAL, Surf_Map->format->palette->colors, 0, Surf_Map->format->palette->ncolors);
+        SDL_FillRect(surfaces[i], nullptr, i);
+        drawChrome(surfaces[i]);
+    }
+    SDL_Surface* overlay = surfaces[0];
+    SDL_Surface* other = surfaces[1];
+
+    // find a pixel value for the colorkey that is not used by the chrome (SDL compares only the color bits)
+    const SDL_PixelFormat* format = overlay->format;
+    const Uint32 colorMask = format->BitsPerPixel > 8 ? (format->Rmask | format->Gmask | format->Bmask) : 0xFF;
+    std::vector<Uint32> usedPixels;
+    for(int y = 0; y < overlay->h; y++)
+    {
+        for(int x = 0; x < overlay->w; x++)
+        {
+            const Uint32 pixel = CSurface::GetPixel(overlay, x, y);
+            if(pixel == CSurface::GetPixel(other, x, y))
+                usedPixels.push_back(pixel & colorMask);
+        }
+    }
+    std::sort(usedPixels.begin(), usedPixels.end());
+    Uint32 colorkey = 0;
+    for(Uint32 pixel : usedPixels)
+    {
+        if(pixel == colorkey)
+            colorkey++;
+        else if(pixel > colorkey)
+            break;
+    }
+    if((colorkey & colorMask) != colorkey)
+    {
+        // every pixel value is used, so the chrome has to be drawn each frame
+        SDL_FreeSurface(overlay);
+        SDL_FreeSurface(other);
+        return nullptr;
+    }
+
+    for(int y = 0; y < overlay->h; y++)
+    {
+        for(int x = 0; x < overlay->w; x++)
+        {
+            if(CSurface::GetPixel(overlay, x, y) != CSurface::GetPixel(other, x, y))
+                CSurface::DrawPixel_Color(overlay, x, y, colorkey);
+        }
+    }
+    SDL_FreeSurface(other);
+    // most of the overlay is transparent, so RLE skips it fast
+    SDL_SetColorKey(overlay, SDL_SRCCOLORKEY | SDL_RLEACCEL, colorkey);
+    return overlay;
+}
+
+std::array<std::array<Uint32, 0x40>, 3> CMap::terrainColors;
+std::array<Uint8, 0x100> CMap::terrainProperties;
+
 static void getTriangleColor(TriangleTerrainType terrainType, MapType mapType, Sint16& r, Sint16& g, Sint16& b)
 {
     switch(terrainType)
@@ -1420,48 +1630,177 @@ static void getTriangleColor(TriangleTerrainType terrainType, MapType mapType, S
     }
 }
 
-void CMap::drawMinimap(SDL_Surface* Window)
+int CMap::getMinimapScale() const
 {
-    // this variables are needed to reduce the size of minimap-windows of big maps
-    int num_x = (map->width > 256 ? map->width / 256 : 1);
-    int num_y = (map->height > 256 ? map->height / 256 : 1);
+    // this is needed to reduce the size of minimap-windows of big maps
+    // (the minimap has the same proportions as the "real" map, so scale the same rate)
+    return std::max(std::max(map->width / 256, map->height / 256), 1);
+}
 
-    // make sure the minimap has the same proportions as the "real" map, so scale the same rate
-    num_x = (num_x > num_y ? num_x : num_y);
-    num_y = (num_x > num_y ? num_x : num_y);
+void CMap::markRowsChanged(int firstRow, int lastRow)
+{
+    lod_.markRows(firstRow, lastRow);
+    if(minimapDirtyRows_.empty())
+        return;
+    const int scale = getMinimapScale();
+    for(int y = firstRow; y <= lastRow; y++)
+    {
+        const int row = ((y % map->height + map->height) % map->height) / scale;
+        if(row < static_cast<int>(minimapDirtyRows_.size()))
+            minimapDirtyRows_[row] = true;
+    }
+    minimapDirty_ = true;
+}
 
-    // if (Window->w < map->width || Window->h < map->height)
-    // return;
+void CMap::invalidateOverview()
+{
+    minimapDirtyRows_.assign(minimapDirtyRows_.size(), true);
+    minimapDirty_ = true;
+    lod_.invalidate();
+}
 
-    for(int y = 0; y < map->height; y++)
-    {
-        if(y % num_y != 0)
-            continue;
+void CMap::setLight(const LightSettings& settings, bool preview)
+{
+    CSurface::setLight(settings);
+
+    // the visible rows, vertices below the display may be raised into it and vertices above lowered
+    const int viewScale = CMapLod::getScale(lodLevel_);
+    const int firstRow = displayRect.top / TRIANGLE_HEIGHT - TRIANGLE_INCREASE * 0x0A / TRIANGLE_HEIGHT - 2;
+    const int lastRow =
+      (displayRect.top + displayRect.getSize().y * viewScale) / TRIANGLE_HEIGHT + TRIANGLE_INCREASE * (0x3C - 0x0A) / TRIANGLE_HEIGHT + 2;
+    if(!preview || lastRow - firstRow + 1 >= map->height)
+    {
+        CSurface::relight(*map, 0, map->height - 1);
+        invalidateOverview();
+        relightRowsLeft_ = 0;
+        return;
+    }
+    CSurface::relight(*map, firstRow, lastRow);
+    markRowsChanged(firstRow, lastRow);
+    // the rest of the map follows in prepareRender(), starting below the visible rows
+    relightNextRow_ = lastRow + 1;
+    relightRowsLeft_ = map->height - (lastRow - firstRow + 1);
+}
 
-        for(int x = 0; x < map->width; x++)
+void CMap::initTerrainColors()
+{
+    // the colors of the original minimap for terrains without description
+    for(int type = MAP_GREENLAND; type <= MAP_WINTERLAND; type++)
+    {
+        for(unsigned s2Id = 0; s2Id < terrainColors[type].size(); s2Id++)
         {
-            if(x % num_x != 0)
-                continue;
-
             Sint16 r, g, b;
-            getTriangleColor(TriangleTerrainType(map->getVertex(x, y).rsuTexture), map->type, r, g, b);
-
-            Uint32* row = (Uint32*)Window->pixels + (y / num_y + 20) * Window->pitch / 4; //-V206
-            //+6 because of the left window frame
-            Uint32* pixel = row + x / num_x + 6;
-
-            Sint32 vertexLighting = map->getVertex(x, y).i;
-            r = ((r * vertexLighting) >> 16);
-            g = ((g * vertexLighting) >> 16);
-            b = ((b * vertexLighting) >> 16);
-            const auto r8 = (Uint8)(r > 255 ? 255 : (r < 0 ? 0 : r));
-            const auto g8 = (Uint8)(g > 255 ? 255 : (g < 0 ? 0 : g));
-            const auto b8 = (Uint8)(b > 255 ? 255 : (b < 0 ? 0 : b));
-            *pixel = ((r8 << Window->format->Rshift) + (g8 << Window->format->Gshift) + (b8 << Window->format->Bshift));
+            getTriangleColor(TriangleTerrainType(s2Id), MapType(type), r, g, b);
+            terrainColors[type][s2Id] = (r << 16) | (g << 8) | b;
+        }
+    }
+    for(DescIdx<TerrainDesc> i(0); i.value < global::worldDesc.terrain.size(); i.value++)
+    {
+        const TerrainDesc& t = global::worldDesc.get(i);
+        const unsigned type = global::worldDesc.get(t.landscape).s2Id;
+        if(type < terrainColors.size() && t.s2Id < terrainColors[type].size())
+            terrainColors[type][t.s2Id] = t.minimapColor & 0xFFFFFF;
+    }
+}
+
+void CMap::initTerrainProperties()
+{
+    // the classification of the original editor, it decides the build and resource bytes that are saved to the map, so the
+    // terrain descriptions (which differ e.g. for 0x06, 0x13 and the steppe) are not used here
+    terrainProperties.fill(0);
+    terrainProperties[TRIANGLE_TEXTURE_SNOW] = TERRAIN_DEADLY;
+    terrainProperties[TRIANGLE_TEXTURE_LAVA] = TERRAIN_DEADLY;
+    terrainProperties[TRIANGLE_TEXTURE_SWAMP] = TERRAIN_WET;
+    terrainProperties[TRIANGLE_TEXTURE_WATER] = TERRAIN_WET | TERRAIN_WATER;
+    terrainProperties[TRIANGLE_TEXTURE_STEPPE] = TERRAIN_STEPPE;
+    for(Uint8 s2Id : {TRIANGLE_TEXTURE_STEPPE_MEADOW1, TRIANGLE_TEXTURE_MEADOW1, TRIANGLE_TEXTURE_MEADOW2, TRIANGLE_TEXTURE_MEADOW3,
+                      TRIANGLE_TEXTURE_STEPPE_MEADOW2, TRIANGLE_TEXTURE_FLOWER, TRIANGLE_TEXTURE_MINING_MEADOW})
+    {
+        terrainProperties[s2Id] = TERRAIN_MEADOW | TERRAIN_HARBOUR;
+        // the harbour textures have the properties of the texture they are made of
+        terrainProperties[s2Id | 0x40] = TERRAIN_MEADOW;
+    }
+    for(Uint8 s2Id : {TRIANGLE_TEXTURE_MINING1, TRIANGLE_TEXTURE_MINING2, TRIANGLE_TEXTURE_MINING3, TRIANGLE_TEXTURE_MINING4})
+        terrainProperties[s2Id] = TERRAIN_MINEABLE;
+}
+
+void CMap::getTouchingTerrain(const std::array<const MapNode*, 7>& mapVertices, Uint8& common, Uint8& any) const
+{
+    // RSU and USD triangle of the vertex and of its upper left neighbour, RSU of the upper right and USD of the left neighbour
+    const std::array<Uint8, 6> textures = {mapVertices[0]->rsuTexture, mapVertices[0]->usdTexture, mapVertices[1]->rsuTexture,
+                                           mapVertices[1]->usdTexture, mapVertices[2]->rsuTexture, mapVertices[3]->usdTexture};
+    common = 0xFF;
+    any = 0;
+    for(Uint8 texture : textures)
+    {
+        common &= getTerrainProperties(texture);
+        any |= getTerrainProperties(texture);
+    }
+}
+
+void CMap::updateMinimapRow(int row)
+{
+    const int scale = getMinimapScale();
+    const std::array<Uint32, 0x40>& colors = terrainColors[map->type];
+
+    // sum up the lit colors of the vertex rows covered by this minimap row for each vertex column
+    minimapSums_.assign(3 * map->width, 0);
+    int* rSum = minimapSums_.data();
+    int* gSum = rSum + map->width;
+    int* bSum = gSum + map->width;
+    for(int y = row * scale; y < (row + 1) * scale; y++)
+        addLitColors(&map->getVertex(0, y), colors, rSum, gSum, bSum, map->width);
+
+    // box filter: average the scale x scale vertices of each pixel
+    auto* pixel = reinterpret_cast<Uint32*>(static_cast<Uint8*>(Surf_Minimap->pixels) + row * Surf_Minimap->pitch);
+    const SDL_PixelFormat& format = *Surf_Minimap->format;
+    const int count = scale * scale;
+    for(int col = 0; col < Surf_Minimap->w; col++)
+    {
+        int r = 0, g = 0, b = 0;
+        for(int x = col * scale; x < (col + 1) * scale; x++)
+        {
+            r += rSum[x];
+            g += gSum[x];
+            b += bSum[x];
+        }
+        pixel[col] = ((r / count) << format.Rshift) | ((g / count) << format.Gshift) | ((b / count) << format.Bshift);
+    }
+}
+
+void CMap::drawMinimap(SDL_Surface* Window)
+{
+    const int scale = getMinimapScale();
+
+    // the cached minimap has the format of the window, so it is only copied
+    if(!Surf_Minimap || Surf_Minimap->w != map->width / scale || Surf_Minimap->h != map->height / scale
+       || Surf_Minimap->format->BitsPerPixel != 32)
+    {
+        SDL_FreeSurface(Surf_Minimap);
+        Surf_Minimap = SDL_CreateRGBSurface(SDL_SWSURFACE, map->width / scale, map->height / scale, 32, Window->format->Rmask,
+                                            Window->format->Gmask, Window->format->Bmask, 0);
+        if(!Surf_Minimap)
+            return;
+        minimapDirtyRows_.assign(Surf_Minimap->h, true);
+        minimapDirty_ = true;
+    }
+
+    if(minimapDirty_)
+    {
+        for(int row = 0; row < Surf_Minimap->h; row++)
+        {
+            if(minimapDirtyRows_[row])
+            {
+                updateMinimapRow(row);
+                minimapDirtyRows_[row] = false;
+            }
         }
+        minimapDirty_ = false;
     }
 
-    // draw the player flags
+    // 6px is width of left window frame and 20px is the height of the upper window frame
+    CSurface::Draw(Window, Surf_Minimap, 6, 20);
+    // the player flags are drawn onto the window, so flags near the edges of the map are not cut off by the minimap
     for(int i = 0; i < MAXPLAYERS; i++)
     {
         if(PlayerHQx[i] != 0xFFFF && PlayerHQy[i] != 0xFFFF)
@@ -1469,18 +1808,19 @@ void CMap::drawMinimap(SDL_Surface* Window)
             // draw flag
             //%7 cause in the original game there are only 7 players and 7 different flags
             CSurface::Draw(Window, global::bmpArray[FLAG_BLUE_DARK + i % 7].surface,
-                           6 + PlayerHQx[i] / num_x - global::bmpArray[FLAG_BLUE_DARK + i % 7].nx,
-                           20 + PlayerHQy[i] / num_y - global::bmpArray[FLAG_BLUE_DARK + i % 7].ny);
+                           6 + PlayerHQx[i] / scale - global::bmpArray[FLAG_BLUE_DARK + i % 7].nx,
+                           20 + PlayerHQy[i] / scale - global::bmpArray[FLAG_BLUE_DARK + i % 7].ny);
             // write player number
-            CFont::writeText(Window, std::to_string(i + 1), 6 + PlayerHQx[i] / num_x, 20 + PlayerHQy[i] / num_y, 9, FONT_MINTGREEN);
+            CFont::writeText(Window, std::to_string(i + 1), 6 + PlayerHQx[i] / scale, 20 + PlayerHQy[i] / scale, 9, FONT_MINTGREEN);
         }
     }
-
-    // draw the arrow --> 6px is width of left window frame and 20px is the height of the upper window frame
-    CSurface::Draw(
-      Window, global::bmpArray[MAPPIC_ARROWCROSS_ORANGE].surface,
-      6 + (displayRect.left + displayRect.getSize().x / 2) / TRIANGLE_WIDTH / num_x - global::bmpArray[MAPPIC_ARROWCROSS_ORANGE].nx,
-      20 + (displayRect.top + displayRect.getSize().y / 2) / TRIANGLE_HEIGHT / num_y - global::bmpArray[MAPPIC_ARROWCROSS_ORANGE].ny);
+    // the arrow marks the center of the display
+    const int viewScale = CMapLod::getScale(lodLevel_);
+    CSurface::Draw(Window, global::bmpArray[MAPPIC_ARROWCROSS_ORANGE].surface,
+                   6 + (displayRect.left + displayRect.getSize().x / 2 * viewScale) / TRIANGLE_WIDTH / scale
+                     - global::bmpArray[MAPPIC_ARROWCROSS_ORANGE].nx,
+                   20 + (displayRect.top + displayRect.getSize().y / 2 * viewScale) / TRIANGLE_HEIGHT / scale
+                     - global::bmpArray[MAPPIC_ARROWCROSS_ORANGE].ny);
 }
 
 void CMap::modifyVertex()
@@ -1492,6 +1832,9 @@ void CMap::modifyVertex()
     else
         TimeOfLastModification = SDL_GetTicks();
 
+    CTrace::Scope traceScope("modifyVertex", "edit");
+    global::s2->WakeCallback(callback::MinimapMenu);
+
     // save vertices for "undo"
     if(saveCurrentVertices)
     {
@@ -1583,186 +1926,157 @@ void CMap::modifyVertex()
     {
         modifyPlayer(VertexX_, VertexY_);
     }
+
+    updateDirtyVertices();
 }
 
-void CMap::modifyHeightRaise(int VertexX, int VertexY)
+void CMap::restoreVertex(const SavedVertex& vertex)
 {
-    // vertex count for the points
-    int X, Y;
-    MapNode* tempP = &map->getVertex(VertexX, VertexY);
-    // this is to setup the building depending on the vertices around
-    std::array<Point32, 19> tempVertices;
-    calculateVerticesAround(tempVertices, VertexX, VertexY);
+    for(int i = vertex.pos.x - MAX_CHANGE_SECTION - 10 - 2, k = 0; i <= vertex.pos.x + MAX_CHANGE_SECTION + 10 + 2; i++, k++)
+    {
+        for(int j = vertex.pos.y - MAX_CHANGE_SECTION - 10 - 2, l = 0; j <= vertex.pos.y + MAX_CHANGE_SECTION + 10 + 2; j++, l++)
+        {
+            const Point32 pos((i + map->width) % map->width, (j + map->height) % map->height);
+            MapNode& curVertex = map->getVertex(pos);
+            const MapNode& savedVertex = vertex.PointsArroundVertex[l][k];
+            // the vectors are not saved with the vertices, so they are calculated again where the height changed, the light
+            // may have been changed since the vertex was saved
+            if(curVertex.h != savedVertex.h)
+            {
+                markDirty(pos, DIRTY_FLAT_VECTORS);
+                markDirtyAround<7>(pos.x, pos.y, DIRTY_LIGHT);
+            } else if(curVertex.i != savedVertex.i)
+                markDirty(pos, DIRTY_LIGHT);
+            curVertex = savedVertex;
+        }
+    }
+}
 
-    bool even = false;
-    if(VertexY % 2 == 0)
-        even = true;
+void CMap::markDirty(const Point32& pos, Uint8 flags)
+{
+    if(dirtyFlags_.size() != map->vertex.size())
+    {
+        dirtyFlags_.assign(map->vertex.size(), 0);
+        dirtyVertices_.clear();
+    }
+    Uint8& vertexFlags = dirtyFlags_[pos.y * map->width + pos.x];
+    if(!vertexFlags)
+        dirtyVertices_.push_back(pos);
+    vertexFlags |= flags;
+}
 
-    // DO IT
-    if(tempP->z >= TRIANGLE_INCREASE * (MaxRaiseHeight - 0x0A)) // user specified maximum reached
-        return;
+template<size_t T_size>
+void CMap::markDirtyAround(int x, int y, Uint8 flags)
+{
+    std::array<Point32, T_size> tempVertices;
+    calculateVerticesAround(tempVertices, x, y);
+    for(const Point32& tempVertex : tempVertices)
+        markDirty(tempVertex, flags);
+}
 
-    if(tempP->z >= TRIANGLE_INCREASE * (0x3C - 0x0A)) // maximum reached (0x3C is max)
+void CMap::updateDirtyVertices()
+{
+    if(dirtyVertices_.empty())
         return;
 
-    tempP->y -= TRIANGLE_INCREASE;
-    tempP->z += TRIANGLE_INCREASE;
-    tempP->h += 0x01;
-    CSurface::update_shading(*map, VertexX, VertexY);
-
-    // after (5*TRIANGLE_INCREASE) pixel all vertices around will be raised too
-    // update first vertex left upside
-    X = VertexX - (even ? 1 : 0);
-    if(X < 0)
-        X += map->width;
-    Y = VertexY - 1;
-    if(Y < 0)
-        Y += map->height;
-    // only modify if the other point is lower than the middle point of the hexagon (-5 cause point was raised a few lines before)
-    if(map->getVertex(X, Y).z < tempP->z - (5 * TRIANGLE_INCREASE)) //-V807
-        modifyHeightRaise(X, Y);
-    // update second vertex right upside
-    X = VertexX + (even ? 0 : 1);
-    if(X >= map->width)
-        X -= map->width;
-    Y = VertexY - 1;
-    if(Y < 0)
-        Y += map->height;
-    // only modify if the other point is lower than the middle point of the hexagon (-5 cause point was raised a few lines before)
-    if(map->getVertex(X, Y).z < tempP->z - (5 * TRIANGLE_INCREASE))
-        modifyHeightRaise(X, Y);
-    // update third point bottom left
-    X = VertexX - 1;
-    if(X < 0)
-        X += map->width;
-    Y = VertexY;
-    // only modify if the other point is lower than the middle point of the hexagon (-5 cause point was raised a few lines before)
-    if(map->getVertex(X, Y).z < tempP->z - (5 * TRIANGLE_INCREASE))
-        modifyHeightRaise(X, Y);
-    // update fourth point bottom right
-    X = VertexX + 1;
-    if(X >= map->width)
-        X -= map->width;
-    Y = VertexY;
-    // only modify if the other point is lower than the middle point of the hexagon (-5 cause point was raised a few lines before)
-    if(map->getVertex(X, Y).z < tempP->z - (5 * TRIANGLE_INCREASE))
-        modifyHeightRaise(X, Y);
-    // update fifth point down left
-    X = VertexX - (even ? 1 : 0);
-    if(X < 0)
-        X += map->width;
-    Y = VertexY + 1;
-    if(Y >= map->height)
-        Y -= map->height;
-    // only modify if the other point is lower than the middle point of the hexagon (-5 cause point was raised a few lines before)
-    if(map->getVertex(X, Y).z < tempP->z - (5 * TRIANGLE_INCREASE))
-        modifyHeightRaise(X, Y);
-    // update sixth point down right
-    X = VertexX + (even ? 0 : 1);
-    if(X >= map->width)
-        X -= map->width;
-    Y = VertexY + 1;
-    if(Y >= map->height)
-        Y -= map->height;
-    // only modify if the other point is lower than the middle point of the hexagon (-5 cause point was raised a few lines before)
-    if(map->getVertex(X, Y).z < tempP->z - (5 * TRIANGLE_INCREASE))
-        modifyHeightRaise(X, Y);
-
-    // at least setup the possible building and shading at the vertex and 2 sections around
-    for(int i = 0; i < 19; i++)
+    // each pass needs the results of the passes before for all vertices
+    for(const Point32& pos : dirtyVertices_)
+    {
+        if(dirtyFlags_[pos.y * map->width + pos.x] & DIRTY_FLAT_VECTORS)
+            CSurface::update_flatVectors(*map, pos.x, pos.y);
+    }
+    for(const Point32& pos : dirtyVertices_)
     {
-        modifyBuild(tempVertices[i].x, tempVertices[i].y);
-        modifyShading(tempVertices[i].x, tempVertices[i].y);
+        if(dirtyFlags_[pos.y * map->width + pos.x] & DIRTY_LIGHT)
+            CSurface::update_nodeVector(*map, pos.x, pos.y);
     }
+    for(const Point32& pos : dirtyVertices_)
+    {
+        const Uint8 flags = dirtyFlags_[pos.y * map->width + pos.x];
+        if(flags & DIRTY_SHADING)
+            modifyShading(pos.x, pos.y);
+        if(flags & DIRTY_BUILD)
+            modifyBuild(pos.x, pos.y);
+        if(flags & DIRTY_RESOURCE)
+            modifyResource(pos.x, pos.y, true);
+    }
+
+    for(const Point32& pos : dirtyVertices_)
+        dirtyFlags_[pos.y * map->width + pos.x] = 0;
+    dirtyVertices_.clear();
+}
+
+void CMap::modifyHeightRaise(int VertexX, int VertexY)
+{
+    changeHeight(VertexX, VertexY, 1);
 }
 
 void CMap::modifyHeightReduce(int VertexX, int VertexY)
 {
-    // vertex count for the points
-    int X, Y;
-    MapNode* tempP = &map->getVertex(VertexX, VertexY);
-    // this is to setup the building depending on the vertices around
-    std::array<Point32, 19> tempVertices;
-    calculateVerticesAround(tempVertices, VertexX, VertexY);
+    changeHeight(VertexX, VertexY, -1);
+}
 
-    bool even = false;
-    if(VertexY % 2 == 0)
-        even = true;
+bool CMap::canChangeHeight(const MapNode& vertex, int step) const
+{
+    // user specified limits and the limits of the format (0x00 is min, 0x3C is max)
+    if(step > 0)
+        return vertex.h < MaxRaiseHeight && vertex.h < 0x3C;
+    else
+        return vertex.h > MinReduceHeight && vertex.h > 0x00;
+}
 
-    // DO IT
-    if(tempP->z <= TRIANGLE_INCREASE * (MinReduceHeight - 0x0A)) // user specified minimum reached
+void CMap::changeHeight(int VertexX, int VertexY, int step)
+{
+    if(!canChangeHeight(map->getVertex(VertexX, VertexY), step))
         return;
 
-    if(tempP->z <= TRIANGLE_INCREASE * (0x00 - 0x0A)) // minimum reached (0x00 is min)
-        return;
+    if(heightVisited_.size() != map->vertex.size())
+    {
+        heightVisited_.assign(map->vertex.size(), 0);
+        heightVisitStamp_ = 0;
+    }
+    if(++heightVisitStamp_ == 0)
+    {
+        // the stamps wrapped around, old entries could be taken for new ones
+        std::fill(heightVisited_.begin(), heightVisited_.end(), 0);
+        heightVisitStamp_ = 1;
+    }
 
-    tempP->y += TRIANGLE_INCREASE;
-    tempP->z -= TRIANGLE_INCREASE;
-    tempP->h -= 0x01;
-    CSurface::update_shading(*map, VertexX, VertexY);
-    // after (5*TRIANGLE_INCREASE) pixel all vertices around will be reduced too
-    // update first vertex left upside
-    X = VertexX - (even ? 1 : 0);
-    if(X < 0)
-        X += map->width;
-    Y = VertexY - 1;
-    if(Y < 0)
-        Y += map->height;
-    // only modify if the other point is higher than the middle point of the hexagon (+5 cause point was reduced a few lines before)
-    if(map->getVertex(X, Y).z > tempP->z + (5 * TRIANGLE_INCREASE)) //-V807
-        modifyHeightReduce(X, Y);
-    // update second vertex right upside
-    X = VertexX + (even ? 0 : 1);
-    if(X >= map->width)
-        X -= map->width;
-    Y = VertexY - 1;
-    if(Y < 0)
-        Y += map->height;
-    // only modify if the other point is higher than the middle point of the hexagon (+5 cause point was reduced a few lines before)
-    if(map->getVertex(X, Y).z > tempP->z + (5 * TRIANGLE_INCREASE))
-        modifyHeightReduce(X, Y);
-    // update third point bottom left
-    X = VertexX - 1;
-    if(X < 0)
-        X += map->width;
-    Y = VertexY;
-    // only modify if the other point is higher than the middle point of the hexagon (+5 cause point was reduced a few lines before)
-    if(map->getVertex(X, Y).z > tempP->z + (5 * TRIANGLE_INCREASE))
-        modifyHeightReduce(X, Y);
-    // update fourth point bottom right
-    X = VertexX + 1;
-    if(X >= map->width)
-        X -= map->width;
-    Y = VertexY;
-    // only modify if the other point is higher than the middle point of the hexagon (+5 cause point was reduced a few lines before)
-    if(map->getVertex(X, Y).z > tempP->z + (5 * TRIANGLE_INCREASE))
-        modifyHeightReduce(X, Y);
-    // update fifth point down left
-    X = VertexX - (even ? 1 : 0);
-    if(X < 0)
-        X += map->width;
-    Y = VertexY + 1;
-    if(Y >= map->height)
-        Y -= map->height;
-    // only modify if the other point is higher than the middle point of the hexagon (+5 cause point was reduced a few lines before)
-    if(map->getVertex(X, Y).z > tempP->z + (5 * TRIANGLE_INCREASE))
-        modifyHeightReduce(X, Y);
-    // update sixth point down right
-    X = VertexX + (even ? 0 : 1);
-    if(X >= map->width)
-        X -= map->width;
-    Y = VertexY + 1;
-    if(Y >= map->height)
-        Y -= map->height;
-    // only modify if the other point is higher than the middle point of the hexagon (+5 cause point was reduced a few lines before)
-    if(map->getVertex(X, Y).z > tempP->z + (5 * TRIANGLE_INCREASE))
-        modifyHeightReduce(X, Y);
+    // after 5 height steps all vertices around will be changed too. The vertices are changed in the order they are found
+    // (instead of recursing into the neighbours) and each vertex is changed only once.
+    const CHexGrid grid(*map);
+    heightWorklist_.clear();
+    heightWorklist_.push_back(Point32(VertexX, VertexY));
+    heightVisited_[VertexY * map->width + VertexX] = heightVisitStamp_;
+    for(size_t next = 0; next < heightWorklist_.size(); next++)
+    {
+        const Point32 pos = heightWorklist_[next];
+        MapNode& vertex = map->getVertex(pos);
+        vertex.h += step;
+
+        std::array<Point32, 7> around;
+        grid.getVerticesAround(around, pos.x, pos.y);
+        for(int i = CHexGrid::HEX_UPPER_LEFT; i <= CHexGrid::HEX_LOWER_RIGHT; i++)
+        {
+            Uint16& visited = heightVisited_[around[i].y * map->width + around[i].x];
+            const MapNode& neighbour = map->getVertex(around[i]);
+            // only change the other point if it is more than 5 lower (when raising) or higher (when reducing) than this one now
+            if(visited == heightVisitStamp_ || (step > 0 ? neighbour.h >= vertex.h - 5 : neighbour.h <= vertex.h + 5))
+                continue;
+            if(!canChangeHeight(neighbour, step))
+                continue;
+            visited = heightVisitStamp_;
+            heightWorklist_.push_back(around[i]);
+        }
+    }
 
-    // at least setup the possible building and shading at the vertex and 2 sections around
-    for(int i = 0; i < 19; i++)
+    // the light of the vertices and 1 section around, the possible building and shading at the vertices and 2 sections around
+    for(const Point32& pos : heightWorklist_)
     {
-        modifyBuild(tempVertices[i].x, tempVertices[i].y);
-        modifyShading(tempVertices[i].x, tempVertices[i].y);
+        markRowsChanged(pos.y - 1, pos.y + 1);
+        markDirty(pos, DIRTY_FLAT_VECTORS);
+        markDirtyAround<7>(pos.x, pos.y, DIRTY_LIGHT);
+        markDirtyAround<19>(pos.x, pos.y, DIRTY_SHADING | DIRTY_BUILD);
     }
 }
 
@@ -1869,6 +2183,7 @@ void CMap::modifyShading(int VertexX, int VertexY)
 
 void CMap::modifyTexture(int VertexX, int VertexY, bool rsu, bool usd)
 {
+    markRowsChanged(VertexY - 1, VertexY + 1);
     if(modeContent == TRIANGLE_TEXTURE_MEADOW_MIXED || modeContent == TRIANGLE_TEXTURE_MEADOW_MIXED_HARBOUR)
     {
         int newContent = rand() % 3;
@@ -1904,23 +2219,15 @@ void CMap::modifyTexture(int VertexX, int VertexY, bool rsu, bool usd)
     }
 
     // at least setup the possible building and the resources at the vertex and 1 section/2 sections around
-    std::array<Point32, 19> tempVertices;
-    calculateVerticesAround(tempVertices, VertexX, VertexY);
-    for(int i = 0; i < 19; i++)
-    {
-        if(i < 7)
-            modifyBuild(tempVertices[i].x, tempVertices[i].y);
-        modifyResource(tempVertices[i].x, tempVertices[i].y);
-    }
+    markDirtyAround<7>(VertexX, VertexY, DIRTY_BUILD);
+    markDirtyAround<19>(VertexX, VertexY, DIRTY_RESOURCE);
 }
 
 void CMap::modifyTextureMakeHarbour(int VertexX, int VertexY)
 {
+    markRowsChanged(VertexY, VertexY);
     MapNode& vertex = map->getVertex(VertexX, VertexY);
-    if(vertex.rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW1 || vertex.rsuTexture == TRIANGLE_TEXTURE_MEADOW1
-       || vertex.rsuTexture == TRIANGLE_TEXTURE_MEADOW2 || vertex.rsuTexture == TRIANGLE_TEXTURE_MEADOW3
-       || vertex.rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW2 || vertex.rsuTexture == TRIANGLE_TEXTURE_FLOWER
-       || vertex.rsuTexture == TRIANGLE_TEXTURE_MINING_MEADOW)
+    if(getTerrainProperties(vertex.rsuTexture) & TERRAIN_HARBOUR)
     {
         vertex.rsuTexture += 0x40;
     }
@@ -1928,6 +2235,8 @@ void CMap::modifyTextureMakeHarbour(int VertexX, int VertexY)
 
 void CMap::modifyObject(int x, int y)
 {
+    // objects are shown as dots in the zoomed out view
+    lod_.markRows(y, y);
     MapNode& curVertex = map->getVertex(x, y);
     if(mode == EDITOR_MODE_CUT)
     {
@@ -1998,9 +2307,6 @@ void CMap::modifyObject(int x, int y)
 
             curVertex.objectType = newContent;
             curVertex.objectInfo = newContent2;
-
-            // now set up the buildings around the granite
-            modifyBuild(x, y);
         } else if(modeContent == 0x05)
         {
             int newContent = modeContent + rand() % 2;
@@ -2084,10 +2390,7 @@ void CMap::modifyObject(int x, int y)
         }
     }
     // at least setup the possible building at the vertex and 1 section around
-    std::array<Point32, 7> tempVertices;
-    calculateVerticesAround(tempVertices, x, y);
-    for(int i = 0; i < 7; i++)
-        modifyBuild(tempVertices[i].x, tempVertices[i].y);
+    markDirtyAround<7>(x, y, DIRTY_BUILD);
 }
 
 void CMap::modifyAnimal(int VertexX, int VertexY)
@@ -2121,11 +2424,12 @@ void CMap::modifyBuild(int x, int y)
     std::array<const MapNode*, 7> mapVertices;
     for(unsigned i = 0; i < mapVertices.size(); i++)
         mapVertices[i] = &map->getVertex(tempVertices[i]);
+    Uint8 touching, touchingAny;
+    getTouchingTerrain(mapVertices, touching, touchingAny);
 
     // calculate the building using the height of the vertices
     // this building is a mine
-    if(curVertex.rsuTexture == TRIANGLE_TEXTURE_MINING1 || curVertex.rsuTexture == TRIANGLE_TEXTURE_MINING2
-       || curVertex.rsuTexture == TRIANGLE_TEXTURE_MINING3 || curVertex.rsuTexture == TRIANGLE_TEXTURE_MINING4)
+    if(getTerrainProperties(curVertex.rsuTexture) & TERRAIN_MINEABLE)
     {
         building = 0x05;
         // test vertex lower right
@@ -2208,24 +2512,16 @@ void CMap::modifyBuild(int x, int y)
     // test if there is snow or lava at the vertex or around the vertex and touching the vertex (first section)
     if(building > 0x00)
     {
-        if(mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_SNOW || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_SNOW
-           || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_LAVA || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_LAVA
-           || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_SNOW || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_SNOW
-           || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_LAVA || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_LAVA
-           || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_SNOW || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_LAVA
-           || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_SNOW || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_LAVA)
-        {
+        if(touchingAny & TERRAIN_DEADLY)
             building = 0x00;
-        }
     }
 
     // test if there is snow or lava on the right side (RSU), in lower left (USD) or in lower right (first section)
     if(building > 0x01)
     {
-        if(mapVertices[4]->rsuTexture == TRIANGLE_TEXTURE_SNOW || mapVertices[4]->rsuTexture == TRIANGLE_TEXTURE_LAVA
-           || mapVertices[5]->usdTexture == TRIANGLE_TEXTURE_SNOW || mapVertices[5]->usdTexture == TRIANGLE_TEXTURE_LAVA
-           || mapVertices[6]->rsuTexture == TRIANGLE_TEXTURE_SNOW || mapVertices[6]->usdTexture == TRIANGLE_TEXTURE_SNOW
-           || mapVertices[6]->rsuTexture == TRIANGLE_TEXTURE_LAVA || mapVertices[6]->usdTexture == TRIANGLE_TEXTURE_LAVA)
+        if((getTerrainProperties(mapVertices[4]->rsuTexture) | getTerrainProperties(mapVertices[5]->usdTexture)
+            | getTerrainProperties(mapVertices[6]->rsuTexture) | getTerrainProperties(mapVertices[6]->usdTexture))
+           & TERRAIN_DEADLY)
         {
             building = 0x01;
         }
@@ -2234,68 +2530,26 @@ void CMap::modifyBuild(int x, int y)
     // test if vertex is surrounded by water or swamp
     if(building > 0x00)
     {
-        if((mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_WATER || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_SWAMP)
-           && (mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_WATER || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_SWAMP)
-           && (mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_WATER || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_SWAMP)
-           && (mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_WATER || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_SWAMP)
-           && (mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_WATER || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_SWAMP)
-           && (mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_WATER || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_SWAMP))
-        {
+        if(touching & TERRAIN_WET)
             building = 0x00;
-        } else if((mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_WATER || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_SWAMP)
-                  || (mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_WATER || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_SWAMP)
-                  || (mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_WATER || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_SWAMP)
-                  || (mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_WATER || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_SWAMP)
-                  || (mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_WATER || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_SWAMP)
-                  || (mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_WATER || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_SWAMP))
-        {
+        else if(touchingAny & TERRAIN_WET)
             building = 0x01;
-        }
     }
 
     // test if there is steppe at the vertex or touching the vertex
     if(building > 0x01)
     {
-        if(mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_STEPPE || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_STEPPE
-           || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_STEPPE || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_STEPPE
-           || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_STEPPE || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_STEPPE)
-        {
+        if(touchingAny & TERRAIN_STEPPE)
             building = 0x01;
-        }
     }
 
     // test if vertex is surrounded by mining-textures
     if(building > 0x01)
     {
-        if((mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING2
-            || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING4)
-           && (mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING2
-               || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING4)
-           && (mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING2
-               || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING4)
-           && (mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING2
-               || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING4)
-           && (mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING2
-               || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING4)
-           && (mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING2
-               || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING4))
-        {
+        if(touching & TERRAIN_MINEABLE)
             building = 0x05;
-        } else if((mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING2
-                   || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING4)
-                  || (mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING2
-                      || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING4)
-                  || (mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING2
-                      || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING4)
-                  || (mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING2
-                      || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING4)
-                  || (mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING2
-                      || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING4)
-                  || (mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING2
-                      || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING4))
-        {
+        else if(touchingAny & TERRAIN_MINEABLE)
             building = 0x01;
-        }
     }
 
     // test for headquarters around the point
@@ -2338,7 +2592,7 @@ void CMap::modifyBuild(int x, int y)
     curVertex.build = building;
 }
 
-void CMap::modifyResource(int x, int y)
+void CMap::modifyResource(int x, int y, bool recalculateOnly)
 {
     // at first save all vertices we need to check
     std::array<Point32, 19> tempVertices;
@@ -2347,103 +2601,40 @@ void CMap::modifyResource(int x, int y)
     std::array<const MapNode*, 7> mapVertices;
     for(unsigned i = 0; i < mapVertices.size(); i++)
         mapVertices[i] = &map->getVertex(tempVertices[i]);
+    Uint8 touching, touchingAny;
+    getTouchingTerrain(mapVertices, touching, touchingAny);
+
+    // the other triangles of the first section and the triangles of the second section touching the first section
+    Uint8 around = 0xFF;
+    for(Uint8 texture : {mapVertices[2]->usdTexture, mapVertices[3]->rsuTexture})
+        around &= getTerrainProperties(texture);
+    for(int i : {4, 5, 6, 7, 8, 10})
+    {
+        const MapNode& vertexI = map->getVertex(tempVertices[i]);
+        around &= getTerrainProperties(vertexI.rsuTexture) & getTerrainProperties(vertexI.usdTexture);
+    }
+    for(int i : {9, 11})
+        around &= getTerrainProperties(map->getVertex(tempVertices[i]).rsuTexture);
+    for(int i : {12, 14})
+        around &= getTerrainProperties(map->getVertex(tempVertices[i]).usdTexture);
 
     // SPECIAL CASE: test if we should set water only
     // test if vertex is surrounded by meadow and meadow-like textures
-    if((mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW1
-        || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW1_HARBOUR || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MEADOW1
-        || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MEADOW1_HARBOUR || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MEADOW2
-        || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MEADOW2_HARBOUR || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MEADOW3
-        || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MEADOW3_HARBOUR || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW2
-        || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW2_HARBOUR || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_FLOWER
-        || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_FLOWER_HARBOUR || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING_MEADOW
-        || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING_MEADOW_HARBOUR)
-       && (mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW1
-           || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW1_HARBOUR
-           || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MEADOW1 || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MEADOW1_HARBOUR
-           || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MEADOW2 || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MEADOW2_HARBOUR
-           || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MEADOW3 || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MEADOW3_HARBOUR
-           || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW2
-           || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW2_HARBOUR || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_FLOWER
-           || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_FLOWER_HARBOUR || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING_MEADOW
-           || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING_MEADOW_HARBOUR)
-       && (mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW1
-           || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW1_HARBOUR
-           || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MEADOW1 || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MEADOW1_HARBOUR
-           || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MEADOW2 || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MEADOW2_HARBOUR
-           || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MEADOW3 || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MEADOW3_HARBOUR
-           || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW2
-           || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW2_HARBOUR || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_FLOWER
-           || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_FLOWER_HARBOUR || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING_MEADOW
-           || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING_MEADOW_HARBOUR)
-       && (mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW1
-           || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW1_HARBOUR
-           || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MEADOW1 || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MEADOW1_HARBOUR
-           || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MEADOW2 || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MEADOW2_HARBOUR
-           || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MEADOW3 || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MEADOW3_HARBOUR
-           || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW2
-           || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW2_HARBOUR || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_FLOWER
-           || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_FLOWER_HARBOUR || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING_MEADOW
-           || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING_MEADOW_HARBOUR)
-       && (mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW1
-           || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW1_HARBOUR
-           || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MEADOW1 || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MEADOW1_HARBOUR
-           || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MEADOW2 || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MEADOW2_HARBOUR
-           || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MEADOW3 || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MEADOW3_HARBOUR
-           || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW2
-           || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW2_HARBOUR || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_FLOWER
-           || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_FLOWER_HARBOUR || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING_MEADOW
-           || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING_MEADOW_HARBOUR)
-       && (mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW1
-           || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW1_HARBOUR
-           || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MEADOW1 || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MEADOW1_HARBOUR
-           || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MEADOW2 || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MEADOW2_HARBOUR
-           || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MEADOW3 || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MEADOW3_HARBOUR
-           || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW2
-           || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_STEPPE_MEADOW2_HARBOUR || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_FLOWER
-           || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_FLOWER_HARBOUR || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING_MEADOW
-           || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING_MEADOW_HARBOUR))
+    if(touching & TERRAIN_MEADOW)
     {
         curVertex.resource = 0x21;
     }
     // SPECIAL CASE: test if we should set fishes only
     // test if vertex is surrounded by water (first section) and at least one non-water texture in the second section
-    else if((mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_WATER) && (mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_WATER)
-            && (mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_WATER) && (mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_WATER)
-            && (mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_WATER) && (mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_WATER)
-            && (mapVertices[2]->usdTexture != TRIANGLE_TEXTURE_WATER || mapVertices[3]->rsuTexture != TRIANGLE_TEXTURE_WATER
-                || mapVertices[4]->rsuTexture != TRIANGLE_TEXTURE_WATER || mapVertices[4]->usdTexture != TRIANGLE_TEXTURE_WATER
-                || mapVertices[5]->rsuTexture != TRIANGLE_TEXTURE_WATER || mapVertices[5]->usdTexture != TRIANGLE_TEXTURE_WATER
-                || mapVertices[6]->rsuTexture != TRIANGLE_TEXTURE_WATER || mapVertices[6]->usdTexture != TRIANGLE_TEXTURE_WATER
-                || map->getVertex(tempVertices[7]).rsuTexture != TRIANGLE_TEXTURE_WATER
-                || map->getVertex(tempVertices[7]).usdTexture != TRIANGLE_TEXTURE_WATER
-                || map->getVertex(tempVertices[8]).rsuTexture != TRIANGLE_TEXTURE_WATER
-                || map->getVertex(tempVertices[8]).usdTexture != TRIANGLE_TEXTURE_WATER
-                || map->getVertex(tempVertices[9]).rsuTexture != TRIANGLE_TEXTURE_WATER
-                || map->getVertex(tempVertices[10]).rsuTexture != TRIANGLE_TEXTURE_WATER
-                || map->getVertex(tempVertices[10]).usdTexture != TRIANGLE_TEXTURE_WATER
-                || map->getVertex(tempVertices[11]).rsuTexture != TRIANGLE_TEXTURE_WATER
-                || map->getVertex(tempVertices[12]).usdTexture != TRIANGLE_TEXTURE_WATER
-                || map->getVertex(tempVertices[14]).usdTexture != TRIANGLE_TEXTURE_WATER))
+    else if((touching & TERRAIN_WATER) && !(around & TERRAIN_WATER))
     {
         curVertex.resource = 0x87;
     }
     // test if vertex is surrounded by mining textures
-    else if((mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING2
-             || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[0]->rsuTexture == TRIANGLE_TEXTURE_MINING4)
-            && (mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING2
-                || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[0]->usdTexture == TRIANGLE_TEXTURE_MINING4)
-            && (mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING2
-                || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[1]->rsuTexture == TRIANGLE_TEXTURE_MINING4)
-            && (mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING2
-                || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[1]->usdTexture == TRIANGLE_TEXTURE_MINING4)
-            && (mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING2
-                || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[2]->rsuTexture == TRIANGLE_TEXTURE_MINING4)
-            && (mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING1 || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING2
-                || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING3 || mapVertices[3]->usdTexture == TRIANGLE_TEXTURE_MINING4))
+    else if(touching & TERRAIN_MINEABLE)
     {
         // check which resource to set
-        if(mode == EDITOR_MODE_RESOURCE_RAISE)
+        if(!recalculateOnly && mode == EDITOR_MODE_RESOURCE_RAISE)
         {
             // if there is no or another resource at the moment
             if(curVertex.resource == 0x40 || curVertex.resource < modeContent || curVertex.resource > modeContent + 6)
@@ -2455,7 +2646,7 @@ void CMap::modifyResource(int x, int y)
                 if(curVertex.resource != modeContent + 6)
                     curVertex.resource++;
             }
-        } else if(mode == EDITOR_MODE_RESOURCE_REDUCE)
+        } else if(!recalculateOnly && mode == EDITOR_MODE_RESOURCE_REDUCE)
         {
             // minimum not reached?
             if(curVertex.resource != 0x40)
@@ -2473,8 +2664,45 @@ void CMap::modifyResource(int x, int y)
         curVertex.resource = 0x00;
 }
 
+void CMap::recalculateMap()
+{
+    CTrace::Scope traceScope("recalculateMap", "edit");
+
+    CSurface::get_nodeVectors(*map);
+    relightRowsLeft_ = 0;
+
+    // build, shading and resources of a vertex only depend on the heights, textures and objects around it,
+    // so the rows can be calculated in any order
+    const int bands = (map->height + RECALCULATE_BAND_HEIGHT - 1) / RECALCULATE_BAND_HEIGHT;
+    const unsigned threads = std::min<unsigned>(std::max(std::thread::hardware_concurrency(), 1u), bands);
+    std::atomic<int> nextBand{0};
+    auto worker = [&]() {
+        for(int band = nextBand++; band < bands; band = nextBand++)
+        {
+            const int lastRow = std::min<int>((band + 1) * RECALCULATE_BAND_HEIGHT, map->height);
+            for(int y = band * RECALCULATE_BAND_HEIGHT; y < lastRow; y++)
+            {
+                for(int x = 0; x < map->width; x++)
+                {
+                    modifyBuild(x, y);
+                    modifyShading(x, y);
+                    modifyResource(x, y, true);
+                }
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for(unsigned i = 1; i < threads; i++)
+        workers.emplace_back(worker);
+    worker();
+    for(std::thread& thread : workers)
+        thread.join();
+}
+
 void CMap::modifyPlayer(int VertexX, int VertexY)
 {
+    // the headquarters are dots in the zoomed out view (old and new position)
+    invalidateOverview();
     // if we have repositioned a player, we need the old position to recalculate the buildings there
     bool PlayerRePositioned = false;
     int oldPositionX = 0;
@@ -2544,17 +2772,9 @@ void CMap::modifyPlayer(int VertexX, int VertexY)
     }
 
     // at least setup the possible building at the vertex and 2 sections around
-    std::array<Point32, 19> tempVertices;
-    calculateVerticesAround(tempVertices, VertexX, VertexY);
-    for(int i = 0; i < 19; i++)
-        modifyBuild(tempVertices[i].x, tempVertices[i].y);
-
+    markDirtyAround<19>(VertexX, VertexY, DIRTY_BUILD);
     if(PlayerRePositioned)
-    {
-        calculateVerticesAround(tempVertices, oldPositionX, oldPositionY);
-        for(int i = 0; i < 19; i++)
-            modifyBuild(tempVertices[i].x, tempVertices[i].y);
-    }
+        markDirtyAround<19>(oldPositionX, oldPositionY, DIRTY_BUILD);
 }
 
 int CMap::getActiveVertices(int tempChangeSection)
@@ -2618,116 +2838,7 @@ void CMap::calculateVertices()
 template<size_t T_size>
 void CMap::calculateVerticesAround(std::array<Point32, T_size>& newVertices, int x, int y)
 {
-    static_assert(T_size == 1u || T_size == 7u || T_size == 19u, "Only 1, 7 or 19 are allowed");
-    bool even = false;
-    if(y % 2 == 0)
-        even = true;
-
-    newVertices[0].x = x;
-    newVertices[0].y = y;
-
-    if(T_size >= 7u)
-    {
-        newVertices[1].x = x - (even ? 1 : 0);
-        if(newVertices[1].x < 0)
-            newVertices[1].x += map->width;
-        newVertices[1].y = y - 1;
-        if(newVertices[1].y < 0)
-            newVertices[1].y += map->height;
-        newVertices[2].x = x + (even ? 0 : 1);
-        if(newVertices[2].x >= map->width)
-            newVertices[2].x -= map->width;
-        newVertices[2].y = y - 1;
-        if(newVertices[2].y < 0)
-            newVertices[2].y += map->height;
-        newVertices[3].x = x - 1;
-        if(newVertices[3].x < 0)
-            newVertices[3].x += map->width;
-        newVertices[3].y = y;
-        newVertices[4].x = x + 1;
-        if(newVertices[4].x >= map->width)
-            newVertices[4].x -= map->width;
-        newVertices[4].y = y;
-        newVertices[5].x = x - (even ? 1 : 0);
-        if(newVertices[5].x < 0)
-            newVertices[5].x += map->width;
-        newVertices[5].y = y + 1;
-        if(newVertices[5].y >= map->height)
-            newVertices[5].y -= map->height;
-        newVertices[6].x = x + (even ? 0 : 1);
-        if(newVertices[6].x >= map->width)
-            newVertices[6].x -= map->width;
-        newVertices[6].y = y + 1;
-        if(newVertices[6].y >= map->height)
-            newVertices[6].y -= map->height;
-    }
-    if(T_size >= 19)
-    {
-        newVertices[7].x = x - 1;
-        if(newVertices[7].x < 0)
-            newVertices[7].x += map->width;
-        newVertices[7].y = y - 2;
-        if(newVertices[7].y < 0)
-            newVertices[7].y += map->height;
-        newVertices[8].x = x;
-        newVertices[8].y = y - 2;
-        if(newVertices[8].y < 0)
-            newVertices[8].y += map->height;
-        newVertices[9].x = x + 1;
-        if(newVertices[9].x >= map->width)
-            newVertices[9].x -= map->width;
-        newVertices[9].y = y - 2;
-        if(newVertices[9].y < 0)
-            newVertices[9].y += map->height;
-        newVertices[10].x = x - (even ? 2 : 1);
-        if(newVertices[10].x < 0)
-            newVertices[10].x += map->width;
-        newVertices[10].y = y - 1;
-        if(newVertices[10].y < 0)
-            newVertices[10].y += map->height;
-        newVertices[11].x = x + (even ? 1 : 2);
-        if(newVertices[11].x >= map->width)
-            newVertices[11].x -= map->width;
-        newVertices[11].y = y - 1;
-        if(newVertices[11].y < 0)
-            newVertices[11].y += map->height;
-        newVertices[12].x = x - 2;
-        if(newVertices[12].x < 0)
-            newVertices[12].x += map->width;
-        newVertices[12].y = y;
-        newVertices[13].x = x + 2;
-        if(newVertices[13].x >= map->width)
-            newVertices[13].x -= map->width;
-        newVertices[13].y = y;
-        newVertices[14].x = x - (even ? 2 : 1);
-        if(newVertices[14].x < 0)
-            newVertices[14].x += map->width;
-        newVertices[14].y = y + 1;
-        if(newVertices[14].y >= map->height)
-            newVertices[14].y -= map->height;
-        newVertices[15].x = x + (even ? 1 : 2);
-        if(newVertices[15].x >= map->width)
-            newVertices[15].x -= map->width;
-        newVertices[15].y = y + 1;
-        if(newVertices[15].y >= map->height)
-            newVertices[15].y -= map->height;
-        newVertices[16].x = x - 1;
-        if(newVertices[16].x < 0)
-            newVertices[16].x += map->width;
-        newVertices[16].y = y + 2;
-        if(newVertices[16].y >= map->height)
-            newVertices[16].y -= map->height;
-        newVertices[17].x = x;
-        newVertices[17].y = y + 2;
-        if(newVertices[17].y >= map->height)
-            newVertices[17].y -= map->height;
-        newVertices[18].x = x + 1;
-        if(newVertices[18].x >= map->width)
-            newVertices[18].x -= map->width;
-        newVertices[18].y = y + 2;
-        if(newVertices[18].y >= map->height)
-            newVertices[18].y -= map->height;
-    }
+    CHexGrid(*map).getVerticesAround(newVertices, x, y);
 }
 
 void CMap::setupVerticesActivity()
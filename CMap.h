@@ -1,12 +1,15 @@
 #ifndef _CMAP_H
 #define _CMAP_H
 
+#include "CMapLod.h"
+#include "CTrace.h"
 #include "defines.h"
 #include <Point.h>
 #include <SDL.h>
 #include <array>
 #include <list>
 #include <string>
+#include <vector>
 
 struct SavedVertex
 {
@@ -18,15 +21,31 @@ struct SavedVertex
     std::array<std::array<MapNode, (MAX_CHANGE_SECTION + 10 + 2) * 2 + 1>, (MAX_CHANGE_SECTION + 10 + 2) * 2 + 1> PointsArroundVertex;
 };
 
+struct LightSettings;
+
 class CMap
 {
     friend class CDebug;
+    friend class CMapLod;
     friend class CSurface;
 
 private:
     std::string filename_;
     SDL_Surface* Surf_Map;
     SDL_Surface* Surf_RightMenubar;
+    // frame, statues and menubars drawn over the map (colorkeyed, rebuilt when the map surface changes)
+    SDL_Surface* Surf_Chrome;
+    // terrain of the minimap (without frame, player flags and arrow), only changed rows are drawn again
+    SDL_Surface* Surf_Minimap;
+    // rows of Surf_Minimap that have to be drawn again
+    std::vector<bool> minimapDirtyRows_;
+    bool minimapDirty_;
+    // sums of the red, green and blue values of each vertex column for updateMinimapRow() (kept to not allocate for each row)
+    std::vector<int> minimapSums_;
+    // colors and heights for the zoomed out views
+    CMapLod lod_;
+    // 0 = normal view, 1 - CMapLod::MAX_LEVEL = zoomed out view (editing is only possible in the normal view)
+    int lodLevel_;
     bobMAP* map;
     DisplayRectangle displayRect;
     bool active;
@@ -44,10 +63,42 @@ private:
     int modeContent2;
     // is the user currently modifying?
     bool modify;
+    // time the user started modifying (the stroke is traced when the mouse button is released)
+    CTrace::Clock::time_point strokeStart_;
     // necessary for "undo"- and "do"-function
     bool saveCurrentVertices;
     std::list<SavedVertex> undoBuffer;
     std::list<SavedVertex> redoBuffer;
+    // creates Surf_Map if needed and touches the vertices if the user modifies them
+    bool prepareRender();
+    // draws the map with cursor, texts and chrome into surface (Surf_Map or a surface with the same format)
+    void drawMap(SDL_Surface* surface);
+    // draws frame, statues and menubars
+    void drawChrome(SDL_Surface* surface);
+    // composites the chrome once into a colorkeyed surface that is blitted each frame
+    SDL_Surface* createChromeOverlay();
+    // minimap color (0x00RRGGBB) of each s2 terrain id for each map type
+    static std::array<std::array<Uint32, 0x40>, 3> terrainColors;
+    // properties of the terrains modifyBuild() and modifyResource() look at
+    enum TerrainProperty : Uint8
+    {
+        TERRAIN_DEADLY = 1 << 0, // snow and lava
+        TERRAIN_WET = 1 << 1,    // water and swamp
+        TERRAIN_STEPPE = 1 << 2, // allows only flags
+        TERRAIN_MINEABLE = 1 << 3,
+        TERRAIN_WATER = 1 << 4,
+        TERRAIN_MEADOW = 1 << 5, // has water resources
+        TERRAIN_HARBOUR = 1 << 6 // can be made a harbour texture (by adding 0x40)
+    };
+    // TerrainProperty bits of each texture byte (with harbour bit), the same for all map types like in the original editor
+    static std::array<Uint8, 0x100> terrainProperties;
+    Uint8 getTerrainProperties(Uint8 texture) const { return terrainProperties[texture]; }
+    // properties all (common) or at least one (any) of the 6 triangles touching the vertex mapVertices[0] have
+    void getTouchingTerrain(const std::array<const MapNode*, 7>& mapVertices, Uint8& common, Uint8& any) const;
+    // number of vertices in x and y direction that are combined to one minimap pixel
+    int getMinimapScale() const;
+    // draws one row of Surf_Minimap with the average color of the vertices it covers
+    void updateMinimapRow(int row);
     // get the number of the triangle nearest to cursor and save it to VertexX and VertexY
     void storeVerticesFromMouse(Uint16 MouseX, Uint16 MouseY, Uint8 MouseState);
     // blitting coords for the mouse cursor
@@ -81,6 +132,26 @@ private:
     // lock vertical or horizontal movement
     bool HorizontalMovementLocked;
     bool VerticalMovementLocked;
+    // derived data that the modifiers only mark and updateDirtyVertices() recalculates once per modifyVertex() call
+    enum DirtyFlag : Uint8
+    {
+        DIRTY_FLAT_VECTORS = 1 << 0, // height changed, normals of the triangles at the vertex
+        DIRTY_LIGHT = 1 << 1,        // normal and light intensity of the vertex
+        DIRTY_SHADING = 1 << 2,      // modifyShading()
+        DIRTY_BUILD = 1 << 3,        // modifyBuild()
+        DIRTY_RESOURCE = 1 << 4      // modifyResource()
+    };
+    // DirtyFlags of each vertex and the vertices with any flag set (each only once)
+    std::vector<Uint8> dirtyFlags_;
+    std::vector<Point32> dirtyVertices_;
+    // vertices changed by one call of changeHeight() (in the order they were changed)
+    std::vector<Point32> heightWorklist_;
+    // a vertex is in heightWorklist_ if its entry equals heightVisitStamp_ (saves clearing a flag for each vertex on each call)
+    std::vector<Uint16> heightVisited_;
+    Uint16 heightVisitStamp_ = 0;
+    // rows that still have the old light after setLight() in preview mode (relit a few each frame, may be outside the map)
+    int relightNextRow_ = 0;
+    int relightRowsLeft_ = 0;
 
 public:
     CMap(const std::string& filename);
@@ -99,6 +170,8 @@ public:
     void setActive() { active = true; }
     void setInactive() { active = false; }
     bool isActive() { return active; }
+    // true while the mouse button is held and the vertices are modified each frame
+    bool isModifying() const { return modify; }
     int getVertexX() { return VertexX_; }
     int getVertexY() { return VertexY_; }
     bool getRenderBuildHelp() { return RenderBuildHelp; }
@@ -132,8 +205,24 @@ public:
     std::string getAuthor() const { return map->getAuthor(); }
     void setAuthor(const std::string& author) { map->setAuthor(author); }
 
+    // fills the minimap colors from the terrain descriptions (needs the loaded game data)
+    static void initTerrainColors();
+    // fills the terrain properties modifyBuild() and modifyResource() look at
+    static void initTerrainProperties();
     void drawMinimap(SDL_Surface* Window);
+    // the vertex rows firstRow to lastRow (may be outside the map) are drawn again in the minimap and the zoomed out view
+    void markRowsChanged(int firstRow, int lastRow);
+    // the whole minimap and zoomed out view are drawn again (e.g. after rotating the map or changing the lighting)
+    void invalidateOverview();
+    // changes the light of the map, in preview mode only the visible rows are relit at once and the others over the next frames
+    void setLight(const LightSettings& settings, bool preview);
+    int getLodLevel() const { return lodLevel_; }
+    // switches between normal and zoomed out view, the center of the display stays in place
+    void setLodLevel(int level);
     void render();
+    // renders the map to the upper left corner of display, straight into it if it has the format of the map surface
+    // (this saves copying Surf_Map each frame)
+    void renderTo(SDL_Surface* display);
     // get and set some variables necessary for cursor behavior
     void setHexagonMode(bool HexagonMode)
     {
@@ -185,8 +274,17 @@ private:
     int correctMouseBlitX(int VertexX, int VertexY);
     int correctMouseBlitY(int VertexX, int VertexY);
     void modifyVertex();
+    void markDirty(const Point32& pos, Uint8 flags);
+    // writes the saved vertices back and marks the vectors and light that have to be calculated again
+    void restoreVertex(const SavedVertex& vertex);
+    template<size_t T_size>
+    void markDirtyAround(int x, int y, Uint8 flags);
+    void updateDirtyVertices();
     void modifyHeightRaise(int VertexX, int VertexY);
     void modifyHeightReduce(int VertexX, int VertexY);
+    // raises (step = 1) or reduces (step = -1) the vertex and the vertices around that would differ by more than 5 from it
+    void changeHeight(int VertexX, int VertexY, int step);
+    bool canChangeHeight(const MapNode& vertex, int step) const;
     void modifyHeightPlane(int VertexX, int VertexY, Uint8 h);
     void modifyHeightMakeBigHouse(int VertexX, int VertexY);
     void modifyShading(int VertexX, int VertexY);
@@ -195,8 +293,11 @@ private:
     void modifyObject(int x, int y);
     void modifyAnimal(int VertexX, int VertexY);
     void modifyBuild(int x, int y);
-    void modifyResource(int x, int y);
+    // recalculateOnly ignores the resource modes (only sets up the resource that belongs to the textures)
+    void modifyResource(int x, int y, bool recalculateOnly = false);
     void modifyPlayer(int VertexX, int VertexY);
+    // recalculates the vectors of the whole map, then build, shading and resources of all vertices (in several threads)
+    void recalculateMap();
     void rotateMap();
     void MirrorMapOnXAxis();
     void MirrorMapOnYAxis();
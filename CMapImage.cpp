@@ -0,0 +1,246 @@
+#include "CMapImage.h"
+#include "CGame.h"
+#include "CMap.h"
+#include "CSurface.h"
+#include "CTrace.h"
+#include "globals.h"
+#include "libendian/libendian.h"
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+constexpr int CMapImage::TILE_SIZE;
+constexpr int CMapImage::TILE_APRON;
+
+namespace {
+// size of the headers written by writeHeader()
+const unsigned BMP_HEADER_SIZE = 14 + 40;
+// surfaces of the tiles have this format, renderTile() relies on it
+const Uint32 RMASK = 0x00FF0000, GMASK = 0x0000FF00, BMASK = 0x000000FF;
+} // namespace
+
+CMapImage::CMapImage(std::string mapFile, std::string imageFile, unsigned threads, size_t memoryBudget)
+    : mapFile_(std::move(mapFile)), imageFile_(std::move(imageFile)), threads_(threads), memoryBudget_(memoryBudget)
+{
+    if(threads_ == 0)
+        threads_ = std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+int CMapImage::Execute()
+{
+    if(!boost::filesystem::exists(mapFile_))
+    {
+        std::cerr << "Could not find map " << mapFile_ << std::endl;
+        return 1;
+    }
+    if(!global::s2->Init())
+        return 1;
+
+    auto* MapObj = new CMap(mapFile_);
+    global::s2->setMapObj(MapObj);
+    // the tiles are drawn with the 32 bit tilesets
+    MapObj->setBitsPerPixel(32);
+    // all tiles must show the same animation step
+    CSurface::animationsEnabled = false;
+
+    const bool result = renderMap(*MapObj->getMap());
+
+    CSurface::animationsEnabled = true;
+    global::s2->delMapObj();
+    global::s2->Cleanup();
+    return result ? 0 : 1;
+}
+
+bool CMapImage::renderMap(const bobMAP& map)
+{
+    CTrace::Scope traceScope("renderMap", "io", imageFile_);
+
+    const bool bmp = !boost::algorithm::iends_with(imageFile_, ".ppm");
+    const unsigned width = map.width_pixel;
+    const unsigned height = map.height_pixel;
+    // BMP rows are padded to 4 bytes
+    const size_t pitch = bmp ? (width * 3 + 3) & ~size_t(3) : width * 3;
+    if(bmp && pitch * height > 0xFFFFFFFFu - BMP_HEADER_SIZE)
+    {
+        std::cerr << "The map is too large for a BMP image, use a file name ending with .ppm" << std::endl;
+        return false;
+    }
+
+    // the budget is shared by the tile surfaces of the threads and the band, but a band has at least one row of pixels
+    const size_t tileBytes = static_cast<size_t>(TILE_SIZE + 2 * TILE_APRON) * (TILE_SIZE + 2 * TILE_APRON) * 4;
+    const size_t bandBudget = memoryBudget_ > tileBytes * threads_ ? memoryBudget_ - tileBytes * threads_ : 0;
+    const unsigned bandHeight = std::max(std::min<unsigned>(bandBudget / pitch, height), 1u);
+    const unsigned tileHeight = std::min<unsigned>(bandHeight, TILE_SIZE);
+    const unsigned tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+
+    std::vector<SDL_Surface*> surfaces;
+    for(unsigned i = 0; i < threads_; i++)
+    {
+        SDL_Surface* surface = SDL_CreateRGBSurface(SDL_SWSURFACE, TILE_SIZE + 2 * TILE_APRON, TILE_SIZE + 2 * TILE_APRON, 32, RMASK, GMASK,
+                                                    BMASK, 0);
+        if(!surface)
+            break;
+        surfaces.push_back(surface);
+    }
+    if(surfaces.empty())
+    {
+        std::cerr << "Could not create the tile surfaces" << std::endl;
+        return false;
+    }
+
+    FILE* fp = boost::nowide::fopen(imageFile_.c_str(), "wb");
+    if(!fp)
+    {
+        std::cerr << "Could not write image " << imageFile_ << std::endl;
+        for(SDL_Surface* surface : surfaces)
+            SDL_FreeSurface(surface);
+        return false;
+    }
+
+    std::cout << "Rendering " << mapFile_ << " (" << width << "x" << height << " pixels) with " << surfaces.size() << " threads in bands of "
+              << bandHeight << " rows..." << std::endl;
+
+    std::vector<Uint8> band(pitch * bandHeight);
+    // the current band, it is only changed while the workers wait for the next one
+    unsigned bandTop = 0, rows = 0, tilesY = 0;
+    // the threads take the next tile of the band until all are drawn
+    std::atomic<unsigned> nextTile{0};
+    auto drawTiles = [&](SDL_Surface* surface) {
+        for(unsigned tile = nextTile++; tile < tilesX * tilesY; tile = nextTile++)
+        {
+            const Position origin((tile % tilesX) * TILE_SIZE, bandTop + (tile / tilesX) * tileHeight);
+            const Extent size(std::min<unsigned>(TILE_SIZE, width - origin.x),
+                              std::min(tileHeight, bandTop + rows - static_cast<unsigned>(origin.y)));
+            renderTile(map, surface, origin, size, &band[(origin.y - bandTop) * pitch + origin.x * 3], pitch, bmp);
+        }
+    };
+
+    // the workers are started once for the whole image: they wait until a band is started (bandNumber changes),
+    // draw its tiles and report when they are done, the last band is followed by finished
+    std::mutex mutex;
+    std::condition_variable bandStarted, bandDrawn;
+    unsigned bandNumber = 0;
+    unsigned busyWorkers = 0;
+    bool finished = false;
+    auto worker = [&](SDL_Surface* surface) {
+        unsigned drawnBand = 0;
+        for(;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                bandStarted.wait(lock, [&] { return finished || bandNumber != drawnBand; });
+                if(finished)
+                    return;
+                drawnBand = bandNumber;
+            }
+            drawTiles(surface);
+            std::lock_guard<std::mutex> lock(mutex);
+            if(--busyWorkers == 0)
+                bandDrawn.notify_one();
+        }
+    };
+    std::vector<std::thread> workers;
+    for(unsigned i = 1; i < surfaces.size(); i++)
+        workers.emplace_back(worker, surfaces[i]);
+
+    bool success = writeHeader(fp, width, height, bmp);
+    for(unsigned top = 0; top < height && success; top += bandHeight)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bandTop = top;
+            rows = std::min(bandHeight, height - top);
+            tilesY = (rows + tileHeight - 1) / tileHeight;
+            nextTile = 0;
+            busyWorkers = static_cast<unsigned>(workers.size());
+            bandNumber++;
+        }
+        bandStarted.notify_all();
+        drawTiles(surfaces[0]);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            bandDrawn.wait(lock, [&] { return busyWorkers == 0; });
+        }
+
+        if(fwrite(band.data(), pitch, rows, fp) != rows)
+            success = false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    bandStarted.notify_all();
+    for(std::thread& thread : workers)
+        thread.join();
+
+    if(fclose(fp) != 0)
+        success = false;
+    for(SDL_Surface* surface : surfaces)
+        SDL_FreeSurface(surface);
+    if(!success)
+        std::cerr << "Could not write image " << imageFile_ << std::endl;
+    return success;
+}
+
+void CMapImage::renderTile(const bobMAP& map, SDL_Surface* surface, const Position& origin, const Extent& size, Uint8* dest,
+                           size_t destPitch, bool bgr)
+{
+    CTrace::Scope traceScope("tile", "frame");
+
+    // the apron may be outside the map, DrawTriangleField wraps around the map edges
+    DisplayRectangle displayRect;
+    displayRect.setOrigin(origin - Position(TILE_APRON, TILE_APRON));
+    displayRect.setSize(Extent(surface->w, surface->h));
+    SDL_FillRect(surface, nullptr, 0);
+    CSurface::DrawTriangleField(surface, displayRect, map);
+
+    // copy the tile without the apron and convert it to 24 bit
+    for(unsigned y = 0; y < size.y; y++)
+    {
+        const auto* src = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(surface->pixels) + (y + TILE_APRON) * surface->pitch)
+                          + TILE_APRON;
+        Uint8* dst = dest + y * destPitch;
+        for(unsigned x = 0; x < size.x; x++, dst += 3)
+        {
+            const Uint8 r = static_cast<Uint8>(src[x] >> 16);
+            const Uint8 g = static_cast<Uint8>(src[x] >> 8);
+            const Uint8 b = static_cast<Uint8>(src[x]);
+            dst[0] = bgr ? b : r;
+            dst[1] = g;
+            dst[2] = bgr ? r : b;
+        }
+    }
+}
+
+bool CMapImage::writeHeader(FILE* fp, unsigned width, unsigned height, bool bmp)
+{
+    if(!bmp)
+        return fprintf(fp, "P6\n%u %u\n255\n", width, height) > 0;
+
+    const unsigned imageSize = ((width * 3 + 3) & ~3u) * height;
+    // file header
+    fputs("BM", fp);
+    libendian::le_write_ui(BMP_HEADER_SIZE + imageSize, fp);
+    libendian::le_write_ui(0, fp);
+    libendian::le_write_ui(BMP_HEADER_SIZE, fp);
+    // info header, a negative height means the rows are stored from top to bottom (as they are rendered)
+    libendian::le_write_ui(40, fp);
+    libendian::le_write_ui(width, fp);
+    libendian::le_write_ui(static_cast<Uint32>(-static_cast<Sint32>(height)), fp);
+    libendian::le_write_us(1, fp);
+    libendian::le_write_us(24, fp);
+    libendian::le_write_ui(0, fp);
+    libendian::le_write_ui(imageSize, fp);
+    libendian::le_write_ui(2835, fp);
+    libendian::le_write_ui(2835, fp);
+    libendian::le_write_ui(0, fp);
+    libendian::le_write_ui(0, fp);
+    return !ferror(fp);
+}
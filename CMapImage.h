@@ -0,0 +1,38 @@
+#ifndef _CMAPIMAGE_H
+#define _CMAPIMAGE_H
+
+#include "defines.h"
+#include <cstdio>
+#include <string>
+
+// Headless rendering of a whole map at 1:1 with terrain, borders and objects to an image file
+// (started with "--render-map <mapfile> <imagefile>", the image is a BMP or a PPM if the file name ends with ".ppm").
+// The image is rendered in bands of tiles: the tiles of a band are drawn by several threads with DrawTriangleField,
+// then the band is written to the file, so only one band is in memory regardless of the map size.
+class CMapImage
+{
+private:
+    std::string mapFile_;
+    std::string imageFile_;
+    // number of worker threads (0 = number of cores)
+    unsigned threads_;
+    // upper limit for the band and the tile surfaces
+    size_t memoryBudget_;
+
+    // tiles are TILE_SIZE x TILE_SIZE pixels and are drawn with a border of TILE_APRON pixels around them,
+    // so objects and triangles reaching into a tile from its neighbours are drawn completely
+    static constexpr int TILE_SIZE = 512;
+    static constexpr int TILE_APRON = 128;
+
+    bool renderMap(const bobMAP& map);
+    // draws one tile and copies it (without the apron) into the band at dest
+    static void renderTile(const bobMAP& map, SDL_Surface* surface, const Position& origin, const Extent& size, Uint8* dest,
+                           size_t destPitch, bool bgr);
+    static bool writeHeader(FILE* fp, unsigned width, unsigned height, bool bmp);
+
+public:
+    CMapImage(std::string mapFile, std::string imageFile, unsigned threads, size_t memoryBudget);
+    int Execute();
+};
+
+#endif
@@ -0,0 +1,181 @@
+#include "CMapLod.h"
+#include "CMap.h"
+#include "CProfiler.h"
+#include "globals.h"
+#include <algorithm>
+
+constexpr int CMapLod::MAX_LEVEL;
+
+namespace {
+// division and modulo that round towards negative infinity (the view may start left of or above the map)
+int floorDiv(int a, int b)
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+int wrap(int a, int b)
+{
+    return a - floorDiv(a, b) * b;
+}
+
+// colors of the dots that replace the objects
+bool getObjectColor(const MapNode& vertex, Uint8& r, Uint8& g, Uint8& b)
+{
+    switch(vertex.objectInfo)
+    {
+        case 0x80: // player headquarters
+            r = 0xFF, g = 0xFF, b = 0xFF;
+            return true;
+        case 0xC4: // trees
+        case 0xC5:
+        case 0xC6:
+            r = 0x18, g = 0x48, b = 0x10;
+            return true;
+        case 0xC8: // landscape
+            r = 0x70, g = 0x68, b = 0x58;
+            return true;
+        case 0xCC: // granite
+        case 0xCD:
+            r = 0xB0, g = 0xB0, b = 0xA8;
+            return true;
+        default: return false;
+    }
+}
+} // namespace
+
+void CMapLod::markRows(int firstRow, int lastRow)
+{
+    if(dirtyRows_.empty())
+        return;
+    const int height = static_cast<int>(dirtyRows_.size());
+    for(int y = firstRow; y <= lastRow; y++)
+        dirtyRows_[wrap(y, height)] = true;
+    dirty_ = true;
+}
+
+void CMapLod::invalidate()
+{
+    dirtyRows_.assign(dirtyRows_.size(), true);
+    dirty_ = true;
+}
+
+void CMapLod::update(const bobMAP& map)
+{
+    if(widths_[0] != map.width || heights_[0] != map.height)
+    {
+        for(int level = 0; level <= MAX_LEVEL; level++)
+        {
+            widths_[level] = std::max(map.width >> level, 1);
+            heights_[level] = std::max(map.height >> level, 1);
+            levels_[level].assign(widths_[level] * heights_[level], Cell());
+        }
+        dirtyRows_.assign(map.height, true);
+        dirty_ = true;
+    }
+    if(!dirty_)
+        return;
+
+    for(int y = 0; y < map.height; y++)
+    {
+        if(dirtyRows_[y])
+            updateVertexRow(map, y);
+    }
+    // a row of a level is computed again if one of the vertex rows it covers has changed
+    for(int level = 1; level <= MAX_LEVEL; level++)
+    {
+        for(int row = 0; row < heights_[level]; row++)
+        {
+            const int firstY = row << level;
+            const int lastY = std::min<int>((row + 1) << level, map.height);
+            if(std::find(dirtyRows_.begin() + firstY, dirtyRows_.begin() + lastY, true) != dirtyRows_.begin() + lastY)
+                updateLevelRow(level, row);
+        }
+    }
+    dirtyRows_.assign(dirtyRows_.size(), false);
+    dirty_ = false;
+}
+
+void CMapLod::updateVertexRow(const bobMAP& map, int y)
+{
+    const std::array<Uint32, 0x40>& colors = CMap::terrainColors[map.type];
+    Cell* cell = &levels_[0][y * widths_[0]];
+    for(int x = 0; x < map.width; x++, cell++)
+    {
+        const MapNode& vertex = map.getVertex(x, y);
+        cell->h = vertex.h;
+        if(getObjectColor(vertex, cell->r, cell->g, cell->b))
+            continue;
+        // mask out the harbor bit
+        const Uint32 color = colors[vertex.rsuTexture & 0x3F];
+        const Sint32 light = vertex.i;
+        cell->r = static_cast<Uint8>(std::min(std::max(static_cast<Sint32>(color >> 16) * light >> 16, 0), 255));
+        cell->g = static_cast<Uint8>(std::min(std::max(static_cast<Sint32>((color >> 8) & 0xFF) * light >> 16, 0), 255));
+        cell->b = static_cast<Uint8>(std::min(std::max(static_cast<Sint32>(color & 0xFF) * light >> 16, 0), 255));
+    }
+}
+
+void CMapLod::updateLevelRow(int level, int row)
+{
+    Cell* cell = &levels_[level][row * widths_[level]];
+    // odd rows are shifted by half a cell, which is one cell of the level below
+    const int shift = row & 1;
+    for(int x = 0; x < widths_[level]; x++, cell++)
+    {
+        const Cell& c00 = getCell(level - 1, 2 * x + shift, 2 * row);
+        const Cell& c10 = getCell(level - 1, 2 * x + shift + 1, 2 * row);
+        const Cell& c01 = getCell(level - 1, 2 * x + shift, 2 * row + 1);
+        const Cell& c11 = getCell(level - 1, 2 * x + shift + 1, 2 * row + 1);
+        cell->r = static_cast<Uint8>((c00.r + c10.r + c01.r + c11.r) / 4);
+        cell->g = static_cast<Uint8>((c00.g + c10.g + c01.g + c11.g) / 4);
+        cell->b = static_cast<Uint8>((c00.b + c10.b + c01.b + c11.b) / 4);
+        cell->h = static_cast<Uint8>((c00.h + c10.h + c01.h + c11.h) / 4);
+    }
+}
+
+const CMapLod::Cell& CMapLod::getCell(int level, int x, int y) const
+{
+    return levels_[level][wrap(y, heights_[level]) * widths_[level] + wrap(x, widths_[level])];
+}
+
+void CMapLod::render(SDL_Surface* surface, const DisplayRectangle& displayRect, const bobMAP& map, int level)
+{
+    CProfiler::Scope scope(PROFILE_TERRAIN);
+    update(map);
+
+    const int scale = getScale(level);
+    // position of the view in screen pixels of this level
+    const int viewX = floorDiv(displayRect.left, scale);
+    const int viewY = floorDiv(displayRect.top, scale);
+    // a cell covers (1 << level) vertices, the borders are calculated for each cell so rounding errors don't add up
+    auto cellLeft = [level](int col, int row) { return floorDiv((2 * col + (row & 1)) * TRIANGLE_WIDTH, 2 << level); };
+    auto cellTop = [level](int row) { return floorDiv(row * TRIANGLE_HEIGHT, 1 << level); };
+    auto lift = [scale](const Cell& cell) { return TRIANGLE_INCREASE * (cell.h - 0x0A) / scale; };
+    // cells below the screen may be lifted into it
+    const int maxLift = TRIANGLE_INCREASE * 0x3C / scale;
+
+    // the background is visible where cells are lowered
+    SDL_FillRect(surface, nullptr, SDL_MapRGB(surface->format, 0, 0, 0));
+
+    // one more cell on the left for the shifted odd rows
+    const int firstCol = floorDiv(viewX * (1 << level), TRIANGLE_WIDTH) - 1;
+    const int firstRow = floorDiv(viewY * (1 << level), TRIANGLE_HEIGHT);
+    const int lastRow = floorDiv((viewY + surface->h + maxLift) * (1 << level), TRIANGLE_HEIGHT);
+    for(int row = firstRow; row <= lastRow; row++)
+    {
+        const int top = cellTop(row) - viewY;
+        const int nextTop = cellTop(row + 1) - viewY;
+        for(int col = firstCol; cellLeft(col, row) - viewX < surface->w; col++)
+        {
+            const Cell& cell = getCell(level, col, row);
+            const int y = top - lift(cell);
+            // reach down to the lifted cell below, so steep slopes leave no gaps
+            const int bottom = std::max(nextTop, nextTop - lift(getCell(level, col, row + 1)));
+            SDL_Rect rect;
+            rect.x = static_cast<Sint16>(cellLeft(col, row) - viewX);
+            rect.y = static_cast<Sint16>(y);
+            rect.w = static_cast<Uint16>(cellLeft(col + 1, row) - cellLeft(col, row));
+            rect.h = static_cast<Uint16>(std::max(bottom - y, 1));
+            if(y < surface->h && y + rect.h > 0)
+                SDL_FillRect(surface, &rect, SDL_MapRGB(surface->format, cell.r, cell.g, cell.b));
+        }
+    }
+}
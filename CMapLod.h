@@ -0,0 +1,50 @@
+#ifndef _CMAPLOD_H
+#define _CMAPLOD_H
+
+#include "defines.h"
+#include <SDL.h>
+#include <array>
+#include <vector>
+
+// Pyramid of the map for the zoomed out views: level 0 holds the lit color and height of each vertex (objects are
+// colored dots), each further level averages 2x2 cells of the level below. Like the vertices, the odd rows of each level
+// are shifted by half a cell. Only rows marked as changed are computed again.
+class CMapLod
+{
+public:
+    // level 1 - 3 show the map in 1/4, 1/16 and 1/64 of the size (in each direction) of the normal view: a cell covers
+    // (1 << level) vertices but is only half as wide as a vertex of the level below, so a 1024x1024 map fits on the screen
+    static constexpr int MAX_LEVEL = 3;
+
+    // number of world pixels (of the normal view) that are shown in one screen pixel of a level
+    static int getScale(int level) { return 1 << (2 * level); }
+
+    // the vertex rows firstRow to lastRow (may be outside the map) are computed again
+    void markRows(int firstRow, int lastRow);
+    // the whole pyramid is computed again (e.g. after changing the map type)
+    void invalidate();
+    // draws the map in the given level (1 - MAX_LEVEL), displayRect is in world pixels of the normal view
+    void render(SDL_Surface* surface, const DisplayRectangle& displayRect, const bobMAP& map, int level);
+
+private:
+    struct Cell
+    {
+        Uint8 r, g, b;
+        Uint8 h;
+    };
+
+    std::array<std::vector<Cell>, MAX_LEVEL + 1> levels_;
+    std::array<int, MAX_LEVEL + 1> widths_ = {};
+    std::array<int, MAX_LEVEL + 1> heights_ = {};
+    // vertex rows that have to be computed again
+    std::vector<bool> dirtyRows_;
+    bool dirty_ = true;
+
+    // allocates the levels (if the map size has changed) and computes the dirty rows
+    void update(const bobMAP& map);
+    void updateVertexRow(const bobMAP& map, int y);
+    void updateLevelRow(int level, int row);
+    const Cell& getCell(int level, int x, int y) const;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "CProfiler.h"
+#include <algorithm>
+
+constexpr int CProfiler::HISTORY_SIZE;
+bool CProfiler::enabled = false;
+thread_local std::array<CProfiler::Clock::duration, PROFILE_STAGE_COUNT> CProfiler::frameTimes = {};
+thread_local std::array<Uint32, PROFILE_COUNTER_COUNT> CProfiler::counters = {};
+std::array<Uint32, PROFILE_COUNTER_COUNT> CProfiler::lastCounters = {};
+std::array<std::array<float, CProfiler::HISTORY_SIZE>, PROFILE_STAGE_COUNT> CProfiler::history = {};
+int CProfiler::historyPos = 0;
+int CProfiler::historyCount = 0;
+
+void CProfiler::Scope::next(ProfilerStage stage)
+{
+    if(active_)
+    {
+        const Clock::time_point now = Clock::now();
+        finish(now);
+        start_ = now;
+    }
+    stage_ = stage;
+}
+
+void CProfiler::Scope::stop()
+{
+    if(active_)
+        finish(Clock::now());
+    active_ = false;
+}
+
+void CProfiler::Scope::finish(Clock::time_point end)
+{
+    addTime(stage_, end - start_);
+    // borders and objects are measured for each triangle, DrawTriangleField traces them as one pass
+    if(stage_ != PROFILE_BORDERS && stage_ != PROFILE_OBJECTS)
+        CTrace::addEvent(getStageName(stage_), "frame", start_, end);
+}
+
+void CProfiler::beginFrame()
+{
+    frameTimes.fill(Clock::duration::zero());
+    counters.fill(0);
+}
+
+void CProfiler::endFrame()
+{
+    lastCounters = counters;
+    if(!enabled)
+        return;
+
+    for(int stage = 0; stage < PROFILE_STAGE_COUNT; stage++)
+        history[stage][historyPos] = std::chrono::duration<float, std::milli>(frameTimes[stage]).count();
+    historyPos = (historyPos + 1) % HISTORY_SIZE;
+    historyCount = std::min(historyCount + 1, HISTORY_SIZE);
+}
+
+double CProfiler::getPercentile(ProfilerStage stage, int p)
+{
+    if(historyCount == 0)
+        return 0;
+
+    std::array<float, HISTORY_SIZE> values;
+    std::copy(history[stage].begin(), history[stage].begin() + historyCount, values.begin());
+    // nearest rank
+    const int rank = std::max(1, (historyCount * p + 99) / 100) - 1;
+    std::nth_element(values.begin(), values.begin() + rank, values.begin() + historyCount);
+    return values[rank];
+}
+
+const char* CProfiler::getStageName(ProfilerStage stage)
+{
+    switch(stage)
+    {
+        case PROFILE_EVENTS: return "events";
+        case PROFILE_GAMELOOP: return "gameloop";
+        case PROFILE_TERRAIN: return "terrain";
+        case PROFILE_BORDERS: return "borders";
+        case PROFILE_OBJECTS: return "objects";
+        case PROFILE_CHROME: return "chrome";
+        case PROFILE_COMPOSITION: return "composition";
+        case PROFILE_FLIP: return "flip";
+        default: return "unknown";
+    }
+}
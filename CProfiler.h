@@ -0,0 +1,99 @@
+#ifndef _CPROFILER_H
+#define _CPROFILER_H
+
+#include "CTrace.h"
+#include <SDL.h>
+#include <array>
+#include <chrono>
+
+// stages of a frame that are measured by the profiler
+enum ProfilerStage
+{
+    PROFILE_EVENTS = 0,  // SDL event handling
+    PROFILE_GAMELOOP,    // gameloop callbacks and waste collection
+    PROFILE_TERRAIN,     // textured triangles of the map
+    PROFILE_BORDERS,     // texture borders between triangles
+    PROFILE_OBJECTS,     // trees, stones, animals, buildings and so on
+    PROFILE_CHROME,      // frame, menubars and texts drawn over the map
+    PROFILE_COMPOSITION, // map copy, menus, windows and cursor blitted to the display
+    PROFILE_FLIP,        // SDL_Flip() / SDL_GL_SwapBuffers()
+    PROFILE_STAGE_COUNT
+};
+
+// counters that are summed up for each frame
+enum ProfilerCounter
+{
+    PROFILE_TRIANGLES_SUBMITTED = 0,
+    PROFILE_TRIANGLES_CULLED,
+    PROFILE_TRIANGLES_DRAWN,
+    PROFILE_BLITS,
+    PROFILE_COUNTER_COUNT
+};
+
+// Frame profiler: sums the time spent in each stage over one frame and keeps the last HISTORY_SIZE frames
+// to calculate percentiles. Only measures while enabled (the debugger window enables it) or while tracing,
+// counters are always summed up.
+class CProfiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // number of frames the percentiles are calculated from
+    static constexpr int HISTORY_SIZE = 128;
+
+    // measures the time from construction to destruction (or to next()) and adds it to the stage
+    class Scope
+    {
+    private:
+        ProfilerStage stage_;
+        bool active_;
+        Clock::time_point start_;
+
+    public:
+        explicit Scope(ProfilerStage stage, bool active = true)
+            : stage_(stage), active_(active && (enabled || CTrace::isEnabled())), start_(active_ ? Clock::now() : Clock::time_point())
+        {}
+        ~Scope()
+        {
+            if(active_)
+                finish(Clock::now());
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        // ends the current stage and starts measuring the given one (needs only one clock read)
+        void next(ProfilerStage stage);
+        // ends the measurement before the scope is left
+        void stop();
+
+    private:
+        void finish(Clock::time_point end);
+    };
+
+    static bool enabled;
+
+    // must be called at the start and the end of each frame
+    static void beginFrame();
+    static void endFrame();
+
+    static void addTime(ProfilerStage stage, Clock::duration duration) { frameTimes[stage] += duration; }
+    static void count(ProfilerCounter counter, Uint32 value = 1) { counters[counter] += value; }
+
+    // percentile (0-100) of the stage time in milliseconds over the last frames
+    static double getPercentile(ProfilerStage stage, int p);
+    // counter value of the last finished frame
+    static Uint32 getCounter(ProfilerCounter counter) { return lastCounters[counter]; }
+    static const char* getStageName(ProfilerStage stage);
+
+private:
+    // times and counters of the running frame (per thread, so the map can be drawn by worker threads,
+    // only the main thread's values are used)
+    static thread_local std::array<Clock::duration, PROFILE_STAGE_COUNT> frameTimes;
+    static thread_local std::array<Uint32, PROFILE_COUNTER_COUNT> counters;
+    static std::array<Uint32, PROFILE_COUNTER_COUNT> lastCounters;
+    // ring buffer with the stage times (in milliseconds) of the last frames
+    static std::array<std::array<float, HISTORY_SIZE>, PROFILE_STAGE_COUNT> history;
+    static int historyPos;
+    static int historyCount;
+};
+
+#endif
@@ -1,6 +1,8 @@
 #include "CSurface.h"
 #include "CGame.h"
+#include "CHexGrid.h"
 #include "CMap.h"
+#include "CProfiler.h"
 #include "Rect.h"
 #include "SGE/sge_blib.h"
 #include "SGE/sge_rotation.h"
@@ -10,8 +12,15 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <mutex>
 
 namespace {
+// light intensities are fixed point numbers with 16 bits after the point
+const float LIGHT_SCALE = 65536.0f;
+// SDL remembers the last destination of a blit in the source surface (and unpacks RLE surfaces while blitting),
+// so the same picture must not be blitted by several threads at the same time
+std::mutex blitMutex;
+
 SDL_Rect rect2SDL_Rect(const Rect& rect)
 {
     Point<Sint16> origin(rect.getOrigin());
@@ -45,8 +54,18 @@ void DrawFadedTexturedTrigon(SDL_Surface* dest, const Point16& p1, const Point16
 }
 } // namespace
 
-bool CSurface::drawTextures = false;
+thread_local bool CSurface::drawTextures = false;
+thread_local bool CSurface::drawObjects = false;
 bool CSurface::useOpenGL = false;
+thread_local Uint32 CSurface::drawnTriangles = 0;
+thread_local Uint32 CSurface::drawnPixels = 0;
+thread_local bool CSurface::drawnAnimatedTextures = false;
+thread_local bool CSurface::drawnAnimatedObjects = false;
+bool CSurface::animationsEnabled = true;
+LightSettings CSurface::lightSettings;
+vector CSurface::lightVector = CSurface::get_normVector(CSurface::lightSettings.direction);
+constexpr Uint32 CSurface::OBJECT_ANIMATION_MS;
+constexpr Uint32 CSurface::TEXTURE_ANIMATION_MS;
 
 bool CSurface::Draw(SDL_Surface* Surf_Dest, SDL_Surface* Surf_Src, int X, int Y)
 {
@@ -58,7 +77,9 @@ bool CSurface::Draw(SDL_Surface* Surf_Dest, SDL_Surface* Surf_Src, int X, int Y)
     DestR.x = X;
     DestR.y = Y;
 
+    std::lock_guard<std::mutex> lock(blitMutex);
     SDL_BlitSurface(Surf_Src, nullptr, Surf_Dest, &DestR);
+    CProfiler::count(PROFILE_BLITS);
 
     return true;
 }
@@ -87,7 +108,9 @@ bool CSurface::Draw(SDL_Surface* Surf_Dest, SDL_Surface* Surf_Src, int X, int Y,
         default: return false;
     }
 
+    std::lock_guard<std::mutex> lock(blitMutex);
     sge_transform(Surf_Src, Surf_Dest, (float)angle, 1.0, 1.0, px, py, X, Y, SGE_TSAFE);
+    CProfiler::count(PROFILE_BLITS);
 
     return true;
 }
@@ -109,7 +132,9 @@ bool CSurface::Draw(SDL_Surface* Surf_Dest, SDL_Surface* Surf_Src, int X, int Y,
     SrcR.w = W;
     SrcR.h = H;
 
+    std::lock_guard<std::mutex> lock(blitMutex);
     SDL_BlitSurface(Surf_Src, &SrcR, Surf_Dest, &DestR);
+    CProfiler::count(PROFILE_BLITS);
 
     return true;
 }
@@ -203,11 +228,21 @@ void CSurface::DrawTriangleField(SDL_Surface* display, const DisplayRectangle& d
     assert(displayRect.top < myMap.height_pixel);
     assert(displayRect.bottom > 0);
 
+    drawnTriangles = 0;
+    drawnPixels = 0;
+    drawnAnimatedTextures = false;
+    drawnAnimatedObjects = false;
+
     // draw triangle field
-    // NOTE: WE DO THIS TWICE, AT FIRST ONLY TRIANGLE-TEXTURES, AT SECOND THE TEXTURE-BORDERS AND OBJECTS
-    for(int i = 0; i < 2; i++)
+    // NOTE: WE DO THIS THREE TIMES, AT FIRST ONLY TRIANGLE-TEXTURES, AT SECOND THE TEXTURE-BORDERS, AT THIRD THE OBJECTS
+    // (so objects are never covered by the borders of the rows below and each pass is measured only once)
+    const std::array<ProfilerStage, 3> passStages = {PROFILE_TERRAIN, PROFILE_BORDERS, PROFILE_OBJECTS};
+    for(int i = 0; i < 3; i++)
     {
         drawTextures = (i == 0);
+        drawObjects = (i == 2);
+        CProfiler::Scope scope(passStages[i]);
+        const CTrace::Clock::time_point passStart = CTrace::isEnabled() ? CTrace::Clock::now() : CTrace::Clock::time_point();
 
         for(int k = 0; k < 4; k++)
         {
@@ -293,7 +328,7 @@ void CSurface::DrawTriangleField(SDL_Surface* display, const DisplayRectangle& d
                 {
                     // first RightSideUp
                     tempP2 = myMap.getVertex(width - 1, y + 1);
-                    tempP2.x = 0;
+                    tempP2.VertexX = -1;
                     DrawTriangle(display, displayRect, myMap, type, myMap.getVertex(0, y), tempP2, myMap.getVertex(0, y + 1));
                     for(unsigned x = std::max(col_start, 1); x < width && x <= static_cast<unsigned>(col_end); x++)
                     {
@@ -306,7 +341,7 @@ void CSurface::DrawTriangleField(SDL_Surface* display, const DisplayRectangle& d
                     }
                     // last UpSideDown
                     tempP3 = myMap.getVertex(0, y);
-                    tempP3.x = myMap.getVertex(width - 1, y).x + TRIANGLE_WIDTH;
+                    tempP3.VertexX = width;
                     DrawTriangle(display, displayRect, myMap, type, myMap.getVertex(width - 1, y + 1), myMap.getVertex(width - 1, y),
                                  tempP3);
                 } else
@@ -322,14 +357,14 @@ void CSurface::DrawTriangleField(SDL_Surface* display, const DisplayRectangle& d
                     }
                     // last RightSideUp
                     tempP3 = myMap.getVertex(0, y + 1);
-                    tempP3.x = myMap.getVertex(width - 1, y + 1).x + TRIANGLE_WIDTH;
+                    tempP3.VertexX = width;
                     DrawTriangle(display, displayRect, myMap, type, myMap.getVertex(width - 1, y), myMap.getVertex(width - 1, y + 1),
                                  tempP3);
                     // last UpSideDown
                     tempP1 = myMap.getVertex(0, y + 1);
-                    tempP1.x = myMap.getVertex(width - 1, y + 1).x + TRIANGLE_WIDTH;
+                    tempP1.VertexX = width;
                     tempP3 = myMap.getVertex(0, y);
-                    tempP3.x = myMap.getVertex(width - 1, y).x + TRIANGLE_WIDTH;
+                    tempP3.VertexX = width;
                     DrawTriangle(display, displayRect, myMap, type, tempP1, myMap.getVertex(width - 1, y), tempP3);
                 }
             }
@@ -339,31 +374,34 @@ void CSurface::DrawTriangleField(SDL_Surface* display, const DisplayRectangle& d
             {
                 // RightSideUp
                 tempP2 = myMap.getVertex(x, 0);
-                tempP2.y = height * TRIANGLE_HEIGHT + myMap.getVertex(x, 0).y;
+                tempP2.VertexY = height;
                 tempP3 = myMap.getVertex(x + 1, 0);
-                tempP3.y = height * TRIANGLE_HEIGHT + myMap.getVertex(x + 1, 0).y;
+                tempP3.VertexY = height;
                 DrawTriangle(display, displayRect, myMap, type, myMap.getVertex(x, height - 1), tempP2, tempP3);
                 // UpSideDown
                 tempP1 = myMap.getVertex(x + 1, 0);
-                tempP1.y = height * TRIANGLE_HEIGHT + myMap.getVertex(x + 1, 0).y;
+                tempP1.VertexY = height;
                 DrawTriangle(display, displayRect, myMap, type, tempP1, myMap.getVertex(x, height - 1), myMap.getVertex(x + 1, height - 1));
             }
         }
 
         // last RightSideUp
         tempP2 = myMap.getVertex(width - 1, 0);
-        tempP2.y += height * TRIANGLE_HEIGHT;
+        tempP2.VertexY = height;
         tempP3 = myMap.getVertex(0, 0);
-        tempP3.x = myMap.getVertex(width - 1, 0).x + TRIANGLE_WIDTH;
-        tempP3.y += height * TRIANGLE_HEIGHT;
+        tempP3.VertexX = width;
+        tempP3.VertexY = height;
         DrawTriangle(display, displayRect, myMap, type, myMap.getVertex(width - 1, height - 1), tempP2, tempP3);
         // last UpSideDown
         tempP1 = myMap.getVertex(0, 0);
-        tempP1.x = myMap.getVertex(width - 1, 0).x + TRIANGLE_WIDTH;
-        tempP1.y += height * TRIANGLE_HEIGHT;
+        tempP1.VertexX = width;
+        tempP1.VertexY = height;
         tempP3 = myMap.getVertex(0, height - 1);
-        tempP3.x = myMap.getVertex(width - 1, height - 1).x + TRIANGLE_WIDTH;
+        tempP3.VertexX = width;
         DrawTriangle(display, displayRect, myMap, type, tempP1, myMap.getVertex(width - 1, height - 1), tempP3);
+
+        if(!drawTextures && CTrace::isEnabled())
+            CTrace::addEvent(drawObjects ? "objects" : "borders", "frame", passStart, CTrace::Clock::now());
     }
 }
 
@@ -714,12 +752,18 @@ void CSurface::GetTerrainTextureCoords(MapType mapType, TriangleTerrainType text
 void CSurface::DrawTriangle(SDL_Surface* display, const DisplayRectangle& displayRect, const bobMAP& myMap, MapType type, const MapNode& P1,
                             const MapNode& P2, const MapNode& P3)
 {
-    Point32 p1(P1.x, P1.y);
-    Point32 p2(P2.x, P2.y);
-    Point32 p3(P3.x, P3.y);
+    Point32 p1(P1.getX(), P1.getY());
+    Point32 p2(P2.getX(), P2.getY());
+    Point32 p3(P3.getX(), P3.getY());
+    if(drawTextures)
+        CProfiler::count(PROFILE_TRIANGLES_SUBMITTED);
     // prevent drawing triangles that are not shown
     if(!GetAdjustedPoints(displayRect, myMap, p1, p2, p3))
+    {
+        if(drawTextures)
+            CProfiler::count(PROFILE_TRIANGLES_CULLED);
         return;
+    }
 
     // for moving water, lava, objects and so on
     // This is very tricky: there are ice floes in the winterland and the water under this floes is moving.
@@ -732,7 +776,7 @@ void CSurface::DrawTriangle(SDL_Surface* display, const DisplayRectangle& displa
     static int roundCount = 0;
     static Uint32 roundTimeObjects = SDL_GetTicks();
     static Uint32 roundTimeTextures = SDL_GetTicks();
-    if(SDL_GetTicks() - roundTimeObjects > 30)
+    if(animationsEnabled && SDL_GetTicks() - roundTimeObjects > OBJECT_ANIMATION_MS)
     {
         roundTimeObjects = SDL_GetTicks();
         if(roundCount >= 7)
@@ -740,7 +784,7 @@ void CSurface::DrawTriangle(SDL_Surface* display, const DisplayRectangle& displa
         else
             roundCount++;
     }
-    if(SDL_GetTicks() - roundTimeTextures > 170)
+    if(animationsEnabled && SDL_GetTicks() - roundTimeTextures > TEXTURE_ANIMATION_MS)
     {
         roundTimeTextures = SDL_GetTicks();
         texture_move++;
@@ -774,39 +818,50 @@ void CSurface::DrawTriangle(SDL_Surface* display, const DisplayRectangle& displa
 
     if(drawTextures)
     {
+        drawnTriangles++;
+        CProfiler::count(PROFILE_TRIANGLES_DRAWN);
+        drawnPixels += std::abs((p2.x - p1.x) * (p3.y - p1.y) - (p3.x - p1.x) * (p2.y - p1.y)) / 2;
+
+        // the points are relative to the display now, so they fit into the 16 bit coordinates of SGE
+        const Point16 sp1(p1), sp2(p2), sp3(p3);
         // upper2, ..... are for special use in winterland.
         Point16 upper, left, right, upper2, left2, right2;
         auto const texture = TriangleTerrainType((isRSU ? P1.rsuTexture : P2.usdTexture) & ~0x40); // Mask out harbor bit
         GetTerrainTextureCoords(type, texture, isRSU, texture_move, upper, left, right, upper2, left2, right2);
+        if(texture == TRIANGLE_TEXTURE_WATER || texture == TRIANGLE_TEXTURE_WATER_ || texture == TRIANGLE_TEXTURE_WATER__
+           || texture == TRIANGLE_TEXTURE_LAVA
+           || (type == MAP_WINTERLAND && (texture == TRIANGLE_TEXTURE_SNOW || texture == TRIANGLE_TEXTURE_SWAMP)))
+            drawnAnimatedTextures = true;
 
         // draw the triangle
         // do not shade water and lava
         if(texture == TRIANGLE_TEXTURE_WATER || texture == TRIANGLE_TEXTURE_LAVA)
-            sge_TexturedTrigon(display, p1.x, p1.y, p2.x, p2.y, p3.x, p3.y, Surf_Tileset, upper.x, upper.y, left.x, left.y, right.x,
+            sge_TexturedTrigon(display, sp1.x, sp1.y, sp2.x, sp2.y, sp3.x, sp3.y, Surf_Tileset, upper.x, upper.y, left.x, left.y, right.x,
                                right.y);
         else
         {
             // draw special winterland textures with moving water (ice floe textures)
             if(type == MAP_WINTERLAND && (texture == TRIANGLE_TEXTURE_SNOW || texture == TRIANGLE_TEXTURE_SWAMP))
             {
-                sge_TexturedTrigon(display, p1.x, p1.y, p2.x, p2.y, p3.x, p3.y, Surf_Tileset, upper2.x, upper2.y, left2.x, left2.y,
+                sge_TexturedTrigon(display, sp1.x, sp1.y, sp2.x, sp2.y, sp3.x, sp3.y, Surf_Tileset, upper2.x, upper2.y, left2.x, left2.y,
                                    right2.x, right2.y);
                 if(global::s2->getMapObj()->getBitsPerPixel() == 8)
-                    sge_PreCalcFadedTexturedTrigonColorKeys(display, p1.x, p1.y, p2.x, p2.y, p3.x, p3.y, Surf_Tileset, upper.x, upper.y,
-                                                            left.x, left.y, right.x, right.y, P1.shading << 8, P2.shading << 8,
+                    sge_PreCalcFadedTexturedTrigonColorKeys(display, sp1.x, sp1.y, sp2.x, sp2.y, sp3.x, sp3.y, Surf_Tileset, upper.x,
+                                                            upper.y, left.x, left.y, right.x, right.y, P1.shading << 8, P2.shading << 8,
                                                             P3.shading << 8, gouData[type], colorkeys.data(), colorkeys.size());
                 else
-                    sge_FadedTexturedTrigonColorKeys(display, p1.x, p1.y, p2.x, p2.y, p3.x, p3.y, Surf_Tileset, upper.x, upper.y, left.x,
-                                                     left.y, right.x, right.y, P1.i, P2.i, P3.i, colorkeys.data(), colorkeys.size());
+                    sge_FadedTexturedTrigonColorKeys(display, sp1.x, sp1.y, sp2.x, sp2.y, sp3.x, sp3.y, Surf_Tileset, upper.x, upper.y,
+                                                     left.x, left.y, right.x, right.y, P1.i, P2.i, P3.i, colorkeys.data(),
+                                                     colorkeys.size());
             } else
             {
                 if(global::s2->getMapObj()->getBitsPerPixel() == 8)
-                    sge_PreCalcFadedTexturedTrigon(display, p1.x, p1.y, p2.x, p2.y, p3.x, p3.y, Surf_Tileset, upper.x, upper.y, left.x,
-                                                   left.y, right.x, right.y, P1.shading << 8, P2.shading << 8, P3.shading << 8,
+                    sge_PreCalcFadedTexturedTrigon(display, sp1.x, sp1.y, sp2.x, sp2.y, sp3.x, sp3.y, Surf_Tileset, upper.x, upper.y,
+                                                   left.x, left.y, right.x, right.y, P1.shading << 8, P2.shading << 8, P3.shading << 8,
                                                    gouData[type]);
                 else
-                    sge_FadedTexturedTrigon(display, p1.x, p1.y, p2.x, p2.y, p3.x, p3.y, Surf_Tileset, upper.x, upper.y, left.x, left.y,
-                                            right.x, right.y, P1.i, P2.i, P3.i);
+                    sge_FadedTexturedTrigon(display, sp1.x, sp1.y, sp2.x, sp2.y, sp3.x, sp3.y, Surf_Tileset, upper.x, upper.y, left.x,
+                                            left.y, right.x, right.y, P1.i, P2.i, P3.i);
             }
         }
         return;
@@ -814,14 +869,15 @@ void CSurface::DrawTriangle(SDL_Surface* display, const DisplayRectangle& displa
 
     // blit borders
     /// PRIORITY FROM HIGH TO LOW: SNOW, MINING_MEADOW, STEPPE, STEPPE_MEADOW2, MINING, MEADOW, FLOWER, STEPPE_MEADOW1, SWAMP, WATER, LAVA
-    if(global::s2->getMapObj()->getRenderBorders())
+    if(!drawObjects && global::s2->getMapObj()->getRenderBorders())
     {
         // RSU-Triangle
         if(isRSU)
         {
             // left upper / right lower edge - therefore get the usd-texture from left to compare
-            Uint16 col = (P1.VertexX - 1 < 0 ? myMap.width - 1 : P1.VertexX - 1);
-            MapNode tempP = myMap.getVertex(col, P1.VertexY);
+            // vertices drawn beyond the map edges have positions outside the map
+            Uint16 col = (P1.VertexX - 1 + myMap.width) % myMap.width;
+            MapNode tempP = myMap.getVertex(col, (P1.VertexY + myMap.height) % myMap.height);
 
             SDL_Rect BorderRect;
             auto borderSide = CalcBorders(myMap, tempP.usdTexture, P1.rsuTexture, BorderRect);
@@ -835,7 +891,7 @@ void CSurface::DrawTriangle(SDL_Surface* display, const DisplayRectangle& displa
                 {
                     tmpP1 += Point16(1, 0);
                     tmpP2 += Point16(1, 0);
-                    thirdPt = Point32(tempP.x, tempP.y) - displayRect.getOrigin();
+                    thirdPt = Point32(tempP.getX(), tempP.getY()) - displayRect.getOrigin();
                     // Shift it close to p1
                     auto diff = thirdPt - p1;
                     if(diff.x < -myMap.width_pixel / 2)
@@ -865,8 +921,8 @@ void CSurface::DrawTriangle(SDL_Surface* display, const DisplayRectangle& displa
 
             if(borderSide != BorderPreference::None)
             {
-                Uint16 col = (P1.VertexX - 1 < 0 ? myMap.width - 1 : P1.VertexX - 1);
-                MapNode tempP = myMap.getVertex(col, P1.VertexY);
+                Uint16 col = (P1.VertexX - 1 + myMap.width) % myMap.width;
+                MapNode tempP = myMap.getVertex(col, (P1.VertexY + myMap.height) % myMap.height);
 
                 Point16 tmpP1{p1}, tmpP2{p2};
                 Point32 thirdPt;
@@ -877,7 +933,7 @@ void CSurface::DrawTriangle(SDL_Surface* display, const DisplayRectangle& displa
                     tmpP2 -= Point16(1, 0);
                 } else
                 {
-                    thirdPt = Point32(tempP.x, tempP.y) - displayRect.getOrigin();
+                    thirdPt = Point32(tempP.getX(), tempP.getY()) - displayRect.getOrigin();
                     // Shift it close to p1
                     auto diff = thirdPt - p1;
                     if(diff.x < -myMap.width_pixel / 2)
@@ -900,8 +956,8 @@ void CSurface::DrawTriangle(SDL_Surface* display, const DisplayRectangle& displa
             }
 
             // top / bottom - therefore get the rsu-texture one line above to compare
-            Uint16 row = (P2.VertexY - 1 < 0 ? myMap.height - 1 : P2.VertexY - 1);
-            Uint16 col = (P2.VertexY % 2 == 0 ? P2.VertexX : (P2.VertexX + 1 > myMap.width - 1 ? 0 : P2.VertexX + 1));
+            Uint16 row = (P2.VertexY - 1 + myMap.height) % myMap.height;
+            Uint16 col = (P2.VertexX + (P2.VertexY & 1) + myMap.width) % myMap.width;
             MapNode tempP = myMap.getVertex(col, row);
 
             borderSide = CalcBorders(myMap, tempP.rsuTexture, P2.usdTexture, BorderRect);
@@ -912,7 +968,7 @@ void CSurface::DrawTriangle(SDL_Surface* display, const DisplayRectangle& displa
                     thirdPt = p1;
                 else
                 {
-                    thirdPt = Point32(tempP.x, tempP.y) - displayRect.getOrigin();
+                    thirdPt = Point32(tempP.getX(), tempP.getY()) - displayRect.getOrigin();
                     // Shift it close to p2
                     auto diff = thirdPt - p2;
                     if(diff.x < -myMap.width_pixel / 2)
@@ -934,6 +990,8 @@ void CSurface::DrawTriangle(SDL_Surface* display, const DisplayRectangle& displa
             }
         }
     }
+    if(!drawObjects)
+        return;
 
     // blit picture to vertex (trees, animals, buildings and so on) --> BUT ONLY AT node1 ON RIGHTSIDEUP-TRIANGLES
 
@@ -945,6 +1003,7 @@ void CSurface::DrawTriangle(SDL_Surface* display, const DisplayRectangle& displa
         {
             // tree
             case 0xC4:
+                drawnAnimatedObjects = true;
                 if(P2.objectType >= 0x30 && P2.objectType <= 0x37)
                 {
                     if(P2.objectType + roundCount > 0x37)
@@ -1169,25 +1228,22 @@ void CSurface::get_nodeVectors(bobMAP& myMap)
         {
             // vector of first triangle
             tempP2.x = 0;
-            tempP2.y = myMap.getVertex(width - 1, j + 1).y;
-            tempP2.z = myMap.getVertex(width - 1, j + 1).z;
-            myMap.getVertex(0, j).flatVector = get_flatVector(myMap.getVertex(0, j), tempP2, myMap.getVertex(0, j + 1));
+            tempP2.y = myMap.getVertex(width - 1, j + 1).getY();
+            tempP2.z = myMap.getVertex(width - 1, j + 1).getZ();
+            myMap.getFlatVector(0, j) = get_flatVector(myMap.getVertex(0, j), tempP2, myMap.getVertex(0, j + 1));
 
             for(int i = 1; i < width; i++)
-                myMap.getVertex(i, j).flatVector =
-                  get_flatVector(myMap.getVertex(i, j), myMap.getVertex(i - 1, j + 1), myMap.getVertex(i, j + 1));
+                myMap.getFlatVector(i, j) = get_flatVector(myMap.getVertex(i, j), myMap.getVertex(i - 1, j + 1), myMap.getVertex(i, j + 1));
         } else
         {
             for(int i = 0; i < width - 1; i++)
-                myMap.getVertex(i, j).flatVector =
-                  get_flatVector(myMap.getVertex(i, j), myMap.getVertex(i, j + 1), myMap.getVertex(i + 1, j + 1));
+                myMap.getFlatVector(i, j) = get_flatVector(myMap.getVertex(i, j), myMap.getVertex(i, j + 1), myMap.getVertex(i + 1, j + 1));
 
             // vector of last triangle
-            tempP3.x = myMap.getVertex(width - 1, j + 1).x + TRIANGLE_WIDTH;
-            tempP3.y = myMap.getVertex(0, j + 1).y;
-            tempP3.z = myMap.getVertex(0, j + 1).z;
-            myMap.getVertex(width - 1, j).flatVector =
-              get_flatVector(myMap.getVertex(width - 1, j), myMap.getVertex(width - 1, j + 1), tempP3);
+            tempP3.x = myMap.getVertex(width - 1, j + 1).getX() + TRIANGLE_WIDTH;
+            tempP3.y = myMap.getVertex(0, j + 1).getY();
+            tempP3.z = myMap.getVertex(0, j + 1).getZ();
+            myMap.getFlatVector(width - 1, j) = get_flatVector(myMap.getVertex(width - 1, j), myMap.getVertex(width - 1, j + 1), tempP3);
         }
     }
     // flat vectors of last line
@@ -1197,56 +1253,109 @@ void CSurface::get_nodeVectors(bobMAP& myMap)
         tempP2.y += height * TRIANGLE_HEIGHT;
         tempP3 = myMap.getVertex(i + 1, 0);
         tempP3.y += height * TRIANGLE_HEIGHT;
-        myMap.getVertex(i, height - 1).flatVector = get_flatVector(myMap.getVertex(i, height - 1), tempP2, tempP3);
+        myMap.getFlatVector(i, height - 1) = get_flatVector(myMap.getVertex(i, height - 1), tempP2, tempP3);
     }
     // vector of last Triangle
     tempP2 = myMap.getVertex(width - 1, 0);
     tempP2.y += height * TRIANGLE_HEIGHT;
-    tempP3.x = myMap.getVertex(width - 1, 0).x + TRIANGLE_WIDTH;
-    tempP3.y = height * TRIANGLE_HEIGHT + myMap.getVertex(0, 0).y;
-    tempP3.z = myMap.getVertex(0, 0).z;
-    myMap.getVertex(width - 1, height - 1).flatVector = get_flatVector(myMap.getVertex(width - 1, height - 1), tempP2, tempP3);
+    tempP3.x = myMap.getVertex(width - 1, 0).getX() + TRIANGLE_WIDTH;
+    tempP3.y = height * TRIANGLE_HEIGHT + myMap.getVertex(0, 0).getY();
+    tempP3.z = myMap.getVertex(0, 0).getZ();
+    myMap.getFlatVector(width - 1, height - 1) = get_flatVector(myMap.getVertex(width - 1, height - 1), tempP2, tempP3);
 
-    // now get the vector at each node and save it to myMap.getVertex(j*width+i, 0).normVector
+    // now get the vector at each node and save it to myMap.getNormVector(i, j), the rows are calculated in one batch
+    // except for the vertex that wraps around the map edge (update_nodeVector() calculates the same for a single vertex)
     for(int j = 0; j < height; j++)
     {
+        // the row above the first one is the last one
+        const int jM1 = (j == 0 ? height - 1 : j - 1);
         if(j % 2 == 0)
         {
-            for(int i = 0; i < width; i++)
-            {
-                MapNode& curVertex = myMap.getVertex(i, j);
-                int iM1 = (i == 0 ? width - 1 : i - 1);
-                if(j == 0) // first line
-                    curVertex.normVector = get_nodeVector(myMap.getVertex(iM1, height - 1).flatVector,
-                                                          myMap.getVertex(i, height - 1).flatVector, curVertex.flatVector);
-                else
-                    curVertex.normVector =
-                      get_nodeVector(myMap.getVertex(iM1, j - 1).flatVector, myMap.getVertex(i, j - 1).flatVector, curVertex.flatVector);
-                curVertex.i = get_LightIntensity(curVertex.normVector);
-            }
+            update_nodeVector(myMap, 0, j);
+            get_nodeVectorRow(&myMap.getFlatVector(0, jM1), &myMap.getFlatVector(1, jM1), &myMap.getFlatVector(1, j),
+                              &myMap.getNormVector(1, j), &myMap.getVertex(1, j), width - 1);
         } else
         {
-            for(int i = 0; i < width; i++)
-            {
-                MapNode& curVertex = myMap.getVertex(i, j);
-                int iP1 = (i + 1 == width ? 0 : i + 1);
-
-                curVertex.normVector =
-                  get_nodeVector(myMap.getVertex(i, j - 1).flatVector, myMap.getVertex(iP1, j - 1).flatVector, curVertex.flatVector);
-                curVertex.i = get_LightIntensity(curVertex.normVector);
-            }
+            get_nodeVectorRow(&myMap.getFlatVector(0, jM1), &myMap.getFlatVector(1, jM1), &myMap.getFlatVector(0, j),
+                              &myMap.getNormVector(0, j), &myMap.getVertex(0, j), width - 1);
+            update_nodeVector(myMap, width - 1, j);
         }
     }
 }
 
+void CSurface::get_nodeVectorRow(const vector* v1, const vector* v2, const vector* v3, vector* nodes, MapNode* vertices, int count)
+{
+    int i = 0;
+#ifdef S25EDIT_USE_SSE2
+    static_assert(sizeof(vector) == 3 * sizeof(float), "vector must be 3 packed floats");
+    const __m128 lightX = _mm_set1_ps(lightVector.x);
+    const __m128 lightY = _mm_set1_ps(lightVector.y);
+    const __m128 lightZ = _mm_set1_ps(lightVector.z);
+    const __m128 diffuse = _mm_set1_ps(lightSettings.diffuse);
+    const __m128 ambient = _mm_set1_ps(lightSettings.ambient);
+    // 4 vertices at once: their 12 floats are 3 registers with the components x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+    for(; i + 4 <= count; i += 4)
+    {
+        const __m128 s0 = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(&v1[i].x), _mm_loadu_ps(&v2[i].x)), _mm_loadu_ps(&v3[i].x));
+        const __m128 s1 = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(&v1[i].x + 4), _mm_loadu_ps(&v2[i].x + 4)), _mm_loadu_ps(&v3[i].x + 4));
+        const __m128 s2 = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(&v1[i].x + 8), _mm_loadu_ps(&v2[i].x + 8)), _mm_loadu_ps(&v3[i].x + 8));
+        // x0 x1 x2 x3, y0 y1 y2 y3 and z0 z1 z2 z3
+        const __m128 x = _mm_shuffle_ps(s0, _mm_shuffle_ps(s1, s2, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+        const __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(s0, s1, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(s1, s2, _MM_SHUFFLE(2, 2, 3, 3)),
+                                        _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(s0, s1, _MM_SHUFFLE(1, 1, 2, 2)), s2, _MM_SHUFFLE(3, 0, 2, 0));
+        const __m128 length2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+        // vectors of length 0 (should not happen) are left to the scalar version
+        if(_mm_movemask_ps(_mm_cmplt_ps(length2, _mm_set1_ps(1e-30f))))
+            break;
+        // 1 / length with one newton step: r = r * (1.5 - 0.5 * length2 * r * r)
+        __m128 r = _mm_rsqrt_ps(length2);
+        r = _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), length2), _mm_mul_ps(r, r))));
+
+        _mm_storeu_ps(&nodes[i].x, _mm_mul_ps(s0, _mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 0, 0, 0))));
+        _mm_storeu_ps(&nodes[i].x + 4, _mm_mul_ps(s1, _mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 2, 1, 1))));
+        _mm_storeu_ps(&nodes[i].x + 8, _mm_mul_ps(s2, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 2))));
+
+        const __m128 dot =
+          _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, lightX), _mm_mul_ps(y, lightY)), _mm_mul_ps(z, lightZ)), r);
+        const __m128 light = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(dot, diffuse), ambient), _mm_set1_ps(LIGHT_SCALE));
+        alignas(16) Sint32 intensities[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(intensities), _mm_cvttps_epi32(light));
+        for(int k = 0; k < 4; k++)
+            vertices[i + k].i = intensities[k];
+    }
+#endif
+    for(; i < count; i++)
+    {
+        nodes[i] = get_nodeVector(v1[i], v2[i], v3[i]);
+        vertices[i].i = get_LightIntensity(nodes[i]);
+    }
+}
+
 Sint32 CSurface::get_LightIntensity(const vector& node)
 {
     // we calculate the light intensity right now
-    float I, Ip = 1.1f, kd = 1, light_const = 1.0f;
-    vector L = {-10, 5, 0.5f};
-    L = get_normVector(L);
-    I = Ip * kd * (node.x * L.x + node.y * L.y + node.z * L.z) + light_const;
-    return (Sint32)(I * pow(2, 16));
+    const float I =
+      lightSettings.diffuse * (node.x * lightVector.x + node.y * lightVector.y + node.z * lightVector.z) + lightSettings.ambient;
+    return (Sint32)(I * LIGHT_SCALE);
+}
+
+void CSurface::setLight(const LightSettings& settings)
+{
+    lightSettings = settings;
+    lightVector = get_normVector(settings.direction);
+}
+
+void CSurface::relight(bobMAP& myMap, int firstRow, int lastRow)
+{
+    for(int j = firstRow; j <= lastRow; j++)
+    {
+        const int row = (j % myMap.height + myMap.height) % myMap.height;
+        const vector* normVector = &myMap.getNormVector(0, row);
+        MapNode* vertex = &myMap.getVertex(0, row);
+        for(int i = 0; i < myMap.width; i++)
+            vertex[i].i = get_LightIntensity(normVector[i]);
+    }
 }
 
 vector CSurface::get_nodeVector(const vector& v1, const vector& v2, const vector& v3)
@@ -1263,7 +1372,7 @@ vector CSurface::get_nodeVector(const vector& v1, const vector& v2, const vector
 vector CSurface::get_normVector(const vector& v)
 {
     vector normal;
-    auto length = static_cast<float>(sqrt(pow(v.x, 2) + pow(v.y, 2) + pow(v.z, 2)));
+    const float length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
     // in case vector length equals 0 (should not happen)
     if(std::abs(length) < 1e-20f)
     {
@@ -1306,125 +1415,34 @@ vector CSurface::get_flatVector(const IntVector& P1, const IntVector& P2, const
 
 void CSurface::update_shading(bobMAP& myMap, int VertexX, int VertexY)
 {
-    // vertex count for the points
-    int X, Y;
-
-    bool even = false;
-    if(VertexY % 2 == 0)
-        even = true;
-
     update_flatVectors(myMap, VertexX, VertexY);
     update_nodeVector(myMap, VertexX, VertexY);
 
     // now update all nodeVectors around VertexX and VertexY
-    // update first vertex left upside
-    X = VertexX - (even ? 1 : 0);
-    if(X < 0)
-        X += myMap.width;
-    Y = VertexY - 1;
-    if(Y < 0)
-        Y += myMap.height;
-    update_nodeVector(myMap, X, Y);
-    // update second vertex right upside
-    X = VertexX + (even ? 0 : 1);
-    if(X >= myMap.width)
-        X -= myMap.width;
-    Y = VertexY - 1;
-    if(Y < 0)
-        Y += myMap.height;
-    update_nodeVector(myMap, X, Y);
-    // update third point bottom left
-    X = VertexX - 1;
-    if(X < 0)
-        X += myMap.width;
-    Y = VertexY;
-    update_nodeVector(myMap, X, Y);
-    // update fourth point bottom right
-    X = VertexX + 1;
-    if(X >= myMap.width)
-        X -= myMap.width;
-    Y = VertexY;
-    update_nodeVector(myMap, X, Y);
-    // update fifth point down left
-    X = VertexX - (even ? 1 : 0);
-    if(X < 0)
-        X += myMap.width;
-    Y = VertexY + 1;
-    if(Y >= myMap.height)
-        Y -= myMap.height;
-    update_nodeVector(myMap, X, Y);
-    // update sixth point down right
-    X = VertexX + (even ? 0 : 1);
-    if(X >= myMap.width)
-        X -= myMap.width;
-    Y = VertexY + 1;
-    if(Y >= myMap.height)
-        Y -= myMap.height;
-    update_nodeVector(myMap, X, Y);
+    std::array<Point32, 7> around;
+    CHexGrid(myMap).getVerticesAround(around, VertexX, VertexY);
+    for(int i = CHexGrid::HEX_UPPER_LEFT; i <= CHexGrid::HEX_LOWER_RIGHT; i++)
+        update_nodeVector(myMap, around[i].x, around[i].y);
 }
 
 void CSurface::update_flatVectors(bobMAP& myMap, int VertexX, int VertexY)
 {
-    // point structures for the triangles, Pmiddle is the point in the middle of the hexagon we will update
-    MapNode *P1, *P2, *P3, *Pmiddle;
-    // vertex count for the points
-    int P1x, P1y, P2x, P2y, P3x, P3y;
-
-    bool even = false;
-    if(VertexY % 2 == 0)
-        even = true;
-
-    Pmiddle = &myMap.getVertex(VertexX, VertexY);
+    // Pmiddle is the point in the middle of the hexagon we will update
+    const MapNode& Pmiddle = myMap.getVertex(VertexX, VertexY);
+    std::array<Point32, 7> around;
+    CHexGrid(myMap).getVerticesAround(around, VertexX, VertexY);
+    const Point32& upperLeft = around[CHexGrid::HEX_UPPER_LEFT];
+    const Point32& upperRight = around[CHexGrid::HEX_UPPER_RIGHT];
 
     // update first triangle left upside
-    P1x = VertexX - (even ? 1 : 0);
-    if(P1x < 0)
-        P1x += myMap.width;
-    P1y = VertexY - 1;
-    if(P1y < 0)
-        P1y += myMap.height;
-    P1 = &myMap.getVertex(P1x, P1y);
-    P2x = VertexX - 1;
-    if(P2x < 0)
-        P2x += myMap.width;
-    P2y = VertexY;
-    P2 = &myMap.getVertex(P2x, P2y);
-    P3 = Pmiddle;
-    P1->flatVector = get_flatVector(*P1, *P2, *P3);
-
+    myMap.getFlatVector(upperLeft.x, upperLeft.y) =
+      get_flatVector(myMap.getVertex(upperLeft), myMap.getVertex(around[CHexGrid::HEX_LEFT]), Pmiddle);
     // update second triangle right upside
-    P1x = VertexX + (even ? 0 : 1);
-    if(P1x >= myMap.width)
-        P1x -= myMap.width;
-    P1y = VertexY - 1;
-    if(P1y < 0)
-        P1y += myMap.height;
-    P1 = &myMap.getVertex(P1x, P1y);
-    P2 = Pmiddle;
-    P3x = VertexX + 1;
-    if(P3x >= myMap.width)
-        P3x -= myMap.width;
-    P3y = VertexY;
-    P3 = &myMap.getVertex(P3x, P3y);
-    P1->flatVector = get_flatVector(*P1, *P2, *P3);
-
+    myMap.getFlatVector(upperRight.x, upperRight.y) =
+      get_flatVector(myMap.getVertex(upperRight), Pmiddle, myMap.getVertex(around[CHexGrid::HEX_RIGHT]));
     // update third triangle down middle
-    P1 = Pmiddle;
-    P2x = VertexX - (even ? 1 : 0);
-    if(P2x < 0)
-        P2x += myMap.width;
-    P2y = VertexY + 1;
-    if(P2y >= myMap.height)
-        P2y -= myMap.height;
-    P2 = &myMap.getVertex(P2x, P2y);
-    P3x = VertexX + (even ? 0 : 1);
-    if(P3x >= myMap.width)
-        P3x -= myMap.width;
-    P3y = VertexY + 1;
-    if(P3y >= myMap.height)
-        P3y -= myMap.height;
-    P3 = &myMap.getVertex(P3x, P3y);
-    P1->flatVector = get_flatVector(*P1, *P2, *P3);
+    myMap.getFlatVector(VertexX, VertexY) =
+      get_flatVector(Pmiddle, myMap.getVertex(around[CHexGrid::HEX_LOWER_LEFT]), myMap.getVertex(around[CHexGrid::HEX_LOWER_RIGHT]));
 }
 
 void CSurface::update_nodeVector(bobMAP& myMap, int VertexX, int VertexY)
@@ -1434,26 +1452,22 @@ void CSurface::update_nodeVector(bobMAP& myMap, int VertexX, int VertexY)
     int width = myMap.width;
     int height = myMap.height;
 
+    vector& normVector = myMap.getNormVector(i, j);
     if(j % 2 == 0)
     {
-        MapNode& curVertex = myMap.getVertex(i, j);
         int iM1 = (i == 0 ? width - 1 : i - 1);
         if(j == 0) // first line
-            curVertex.normVector =
-              get_nodeVector(myMap.getVertex(iM1, height - 1).flatVector, myMap.getVertex(i, height - 1).flatVector, curVertex.flatVector);
+            normVector =
+              get_nodeVector(myMap.getFlatVector(iM1, height - 1), myMap.getFlatVector(i, height - 1), myMap.getFlatVector(i, j));
         else
-            curVertex.normVector =
-              get_nodeVector(myMap.getVertex(iM1, j - 1).flatVector, myMap.getVertex(i, j - 1).flatVector, curVertex.flatVector);
-        curVertex.i = get_LightIntensity(curVertex.normVector);
+            normVector = get_nodeVector(myMap.getFlatVector(iM1, j - 1), myMap.getFlatVector(i, j - 1), myMap.getFlatVector(i, j));
     } else
     {
-        MapNode& curVertex = myMap.getVertex(i, j);
         int iP1 = (i + 1 == width ? 0 : i + 1);
 
-        curVertex.normVector =
-          get_nodeVector(myMap.getVertex(i, j - 1).flatVector, myMap.getVertex(iP1, j - 1).flatVector, curVertex.flatVector);
-        curVertex.i = get_LightIntensity(curVertex.normVector);
+        normVector = get_nodeVector(myMap.getFlatVector(i, j - 1), myMap.getFlatVector(iP1, j - 1), myMap.getFlatVector(i, j));
     }
+    myMap.getVertex(i, j).i = get_LightIntensity(normVector);
 }
 
 float CSurface::absf(float a)
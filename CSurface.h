@@ -3,8 +3,19 @@
 
 #include "defines.h"
 #include <SDL.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define S25EDIT_USE_SSE2
+#endif
 
-struct vector;
+// light of the map: the intensity of a vertex is ambient + diffuse * (node vector * normalized direction), 1 is the unchanged texture
+struct LightSettings
+{
+    // direction to the light (x to the right, y down, z up), does not need to be normalized
+    vector direction = {-10, 5, 0.5f};
+    float ambient = 1.0f;
+    float diffuse = 1.1f;
+};
 
 class CSurface
 {
@@ -26,23 +37,49 @@ public:
                              const MapNode& P1, const MapNode& P2, const MapNode& P3);
 
     static void get_nodeVectors(bobMAP& myMap);
+    // the light is used by all functions calculating node vectors, relight() applies it to the stored node vectors
+    static void setLight(const LightSettings& settings);
+    static const LightSettings& getLight() { return lightSettings; }
+    // recalculates the light intensities of the vertex rows firstRow to lastRow (may be outside the map) from their node vectors
+    static void relight(bobMAP& myMap, int firstRow, int lastRow);
+    // update_flatVectors() and update_nodeVector() of the vertex and update_nodeVector() of its neighbours
     static void update_shading(bobMAP& myMap, int VertexX, int VertexY);
+    // update flatVectors around a vertex
+    static void update_flatVectors(bobMAP& myMap, int VertexX, int VertexY);
+    // update nodeVector based on new flatVectors around it
+    static void update_nodeVector(bobMAP& myMap, int VertexX, int VertexY);
 
     static bool useOpenGL;
+    // DrawTriangleField() may run in several threads at once (each drawing its own surface),
+    // so the statistics and the drawing state below are kept per thread
+    // number of textured triangles and their (unclipped) pixel area drawn by the last DrawTriangleField() call
+    static thread_local Uint32 drawnTriangles;
+    static thread_local Uint32 drawnPixels;
+    // if the last DrawTriangleField() call drew animated textures (water, lava, ice floes) or animated objects (trees)
+    static thread_local bool drawnAnimatedTextures;
+    static thread_local bool drawnAnimatedObjects;
+    // if false, objects and textures stay in their first animation step (must not be changed while drawing)
+    static bool animationsEnabled;
+    // milliseconds between two animation steps of objects and textures
+    static constexpr Uint32 OBJECT_ANIMATION_MS = 30;
+    static constexpr Uint32 TEXTURE_ANIMATION_MS = 170;
 
 private:
-    // to decide what to draw, triangle-textures or objects and texture-borders
-    static bool drawTextures;
+    // to decide what to draw, triangle-textures, texture-borders or objects
+    static thread_local bool drawTextures;
+    static thread_local bool drawObjects;
+    static LightSettings lightSettings;
+    // normalized direction of lightSettings
+    static vector lightVector;
 
     static vector get_nodeVector(const vector& v1, const vector& v2, const vector& v3);
     static vector get_normVector(const vector& v);
     static vector get_flatVector(const IntVector& P1, const IntVector& P2, const IntVector& P3);
     static Sint32 get_LightIntensity(const vector& node);
+    // node vectors (the normalized sums of v1, v2 and v3) and light intensities of count vertices in a row,
+    // with SSE2 4 at a time (the intensities may differ by 1 from get_LightIntensity())
+    static void get_nodeVectorRow(const vector* v1, const vector* v2, const vector* v3, vector* nodes, MapNode* vertices, int count);
     static float absf(float a);
-    // update flatVectors around a vertex
-    static void update_flatVectors(bobMAP& myMap, int VertexX, int VertexY);
-    // update nodeVector based on new flatVectors around it
-    static void update_nodeVector(bobMAP& myMap, int VertexX, int VertexY);
     static void GetTerrainTextureCoords(MapType mapType, TriangleTerrainType texture, bool isRSU, int texture_move, Point16& upper,
                                         Point16& left, Point16& right, Point16& upper2, Point16& left2, Point16& right2);
 };
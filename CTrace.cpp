@@ -0,0 +1,221 @@
+#include "CTrace.h"
+#include <boost/nowide/cstdio.hpp>
+#include <array>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+struct TraceEvent
+{
+    const char* name;
+    const char* category;
+    // 'X' = complete event, 'b' = async event (written as begin and end)
+    char phase;
+    CTrace::Clock::time_point start;
+    CTrace::Clock::duration duration;
+    unsigned asyncId;
+    std::string detail;
+};
+
+// fixed size block of events, blocks are only appended, so events never move while they are written out
+struct EventChunk
+{
+    static constexpr unsigned SIZE = 1024;
+    std::array<TraceEvent, SIZE> events;
+    std::atomic<unsigned> count{0};
+    std::atomic<EventChunk*> next{nullptr};
+};
+
+// events of one thread, only this thread writes to it
+struct ThreadBuffer
+{
+    unsigned tid = 0;
+    std::string name;
+    EventChunk first;
+    EventChunk* last = &first;
+
+    ~ThreadBuffer()
+    {
+        EventChunk* chunk = first.next.load();
+        while(chunk)
+        {
+            EventChunk* next = chunk->next.load();
+            delete chunk;
+            chunk = next;
+        }
+    }
+
+    void push(TraceEvent event)
+    {
+        unsigned count = last->count.load(std::memory_order_relaxed);
+        if(count == EventChunk::SIZE)
+        {
+            auto* chunk = new EventChunk;
+            last->next.store(chunk, std::memory_order_release);
+            last = chunk;
+            count = 0;
+        }
+        last->events[count] = std::move(event);
+        // publish the event after it is completely written
+        last->count.store(count + 1, std::memory_order_release);
+    }
+};
+
+// guards the list of thread buffers and the thread names (NOT the events)
+std::mutex buffersMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+std::string traceFilename;
+CTrace::Clock::time_point traceStart;
+std::atomic<unsigned> nextAsyncId{1};
+bool traceStarted = false;
+
+ThreadBuffer& getThreadBuffer()
+{
+    // only the first event of a thread has to lock
+    thread_local ThreadBuffer* buffer = nullptr;
+    if(!buffer)
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = buffers.back().get();
+        buffer->tid = static_cast<unsigned>(buffers.size());
+    }
+    return *buffer;
+}
+
+void writeString(FILE* fp, const std::string& str)
+{
+    fputc('"', fp);
+    for(char c : str)
+    {
+        if(c == '"' || c == '\\')
+            fprintf(fp, "\\%c", c);
+        else if(static_cast<unsigned char>(c) < 0x20)
+            fprintf(fp, "\\u%04x", c);
+        else
+            fputc(c, fp);
+    }
+    fputc('"', fp);
+}
+
+double microseconds(CTrace::Clock::duration duration)
+{
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+void writeEvent(FILE* fp, unsigned tid, const TraceEvent& event, char phase)
+{
+    fputs(",\n{\"name\":", fp);
+    writeString(fp, event.name);
+    fputs(",\"cat\":", fp);
+    writeString(fp, event.category);
+    const CTrace::Clock::time_point ts = phase == 'e' ? event.start + event.duration : event.start;
+    fprintf(fp, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f", phase, tid, microseconds(ts - traceStart));
+    if(phase == 'X')
+        fprintf(fp, ",\"dur\":%.3f", microseconds(event.duration));
+    else
+        fprintf(fp, ",\"id\":%u", event.asyncId);
+    if(!event.detail.empty())
+    {
+        fputs(",\"args\":{\"detail\":", fp);
+        writeString(fp, event.detail);
+        fputc('}', fp);
+    }
+    fputc('}', fp);
+}
+} // namespace
+
+std::atomic<bool> CTrace::enabled{false};
+
+CTrace::Scope::Scope(const char* name, const char* category, std::string detail)
+    : name_(name), category_(category), active_(isEnabled())
+{
+    if(active_)
+    {
+        detail_ = std::move(detail);
+        start_ = Clock::now();
+    }
+}
+
+CTrace::Scope::~Scope()
+{
+    if(active_)
+        addEvent(name_, category_, start_, Clock::now(), std::move(detail_));
+}
+
+bool CTrace::start(const std::string& filename)
+{
+    if(traceStarted || filename.empty())
+        return false;
+    traceStarted = true;
+    traceFilename = filename;
+    traceStart = Clock::now();
+    setThreadName("main");
+    enabled = true;
+    return true;
+}
+
+bool CTrace::stop()
+{
+    if(!isEnabled())
+        return false;
+    enabled = false;
+
+    FILE* fp = boost::nowide::fopen(traceFilename.c_str(), "w");
+    if(!fp)
+    {
+        std::cerr << "Could not write trace file " << traceFilename << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    // the metadata event at the beginning, so every following event can start with a comma
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", fp);
+    fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"s25edit\"}}", fp);
+    for(const auto& buffer : buffers)
+    {
+        fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", buffer->tid);
+        writeString(fp, buffer->name.empty() ? "thread " + std::to_string(buffer->tid) : buffer->name);
+        fputs("}}", fp);
+
+        for(const EventChunk* chunk = &buffer->first; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+        {
+            const unsigned count = chunk->count.load(std::memory_order_acquire);
+            for(unsigned i = 0; i < count; i++)
+            {
+                const TraceEvent& event = chunk->events[i];
+                if(event.phase == 'X')
+                    writeEvent(fp, buffer->tid, event, 'X');
+                else
+                {
+                    writeEvent(fp, buffer->tid, event, 'b');
+                    writeEvent(fp, buffer->tid, event, 'e');
+                }
+            }
+        }
+    }
+    fputs("\n]}\n", fp);
+    fclose(fp);
+    return true;
+}
+
+void CTrace::addEvent(const char* name, const char* category, Clock::time_point start, Clock::time_point end, std::string detail)
+{
+    if(isEnabled())
+        getThreadBuffer().push(TraceEvent{name, category, 'X', start, end - start, 0, std::move(detail)});
+}
+
+void CTrace::addAsyncEvent(const char* name, const char* category, Clock::time_point start, Clock::time_point end, std::string detail)
+{
+    if(isEnabled())
+        getThreadBuffer().push(TraceEvent{name, category, 'b', start, end - start, nextAsyncId++, std::move(detail)});
+}
+
+void CTrace::setThreadName(const std::string& name)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffer.name = name;
+}
@@ -0,0 +1,51 @@
+#ifndef _CTRACE_H
+#define _CTRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// Opt-in trace recorder (started with "--trace <file>"). Writes the recorded events as Chrome trace event JSON
+// that can be opened with chrome://tracing or ui.perfetto.dev.
+// Every thread records into its own buffer without locking, so each thread gets its own track in the viewer.
+class CTrace
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // records a complete event from construction to destruction
+    class Scope
+    {
+    private:
+        const char* name_;
+        const char* category_;
+        std::string detail_;
+        bool active_;
+        Clock::time_point start_;
+
+    public:
+        Scope(const char* name, const char* category, std::string detail = std::string());
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // starts recording (only once per run), the file is written by stop()
+    static bool start(const std::string& filename);
+    static bool stop();
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // name and category must be string literals (only the pointers are stored)
+    static void addEvent(const char* name, const char* category, Clock::time_point start, Clock::time_point end,
+                         std::string detail = std::string());
+    // event on an own track that may overlap the events of the thread (e.g. an edit stroke over several frames)
+    static void addAsyncEvent(const char* name, const char* category, Clock::time_point start, Clock::time_point end,
+                              std::string detail = std::string());
+    // name of the calling thread shown in the viewer
+    static void setThreadName(const std::string& name);
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+#endif
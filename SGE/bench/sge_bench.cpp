@@ -0,0 +1,232 @@
+/*
+ *	SDL Graphics Extension
+ *	Microbenchmarks for the rasterizer primitives used by the editor
+ *
+ *	License: LGPL v2+ (see the file LICENSE)
+ */
+
+/*
+ *  All primitives draw into offscreen software surfaces, so no video mode is needed.
+ *  Every case is run a few times, the median is reported together with the spread
+ *  (max - min relative to the median) of the runs.
+ *
+ *  Usage: sge_bench [repetitions]
+ */
+
+#include "SGE/sge.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int SURFACE_SIZE = 1024;
+constexpr int TEXTURE_SIZE = 256;
+
+/* Number of primitives drawn per run, scaled so every run covers roughly the same pixel count */
+int primitivesPerRun(int size)
+{
+    return std::max(64, 4 * 1024 * 1024 / (size * size));
+}
+
+struct Result
+{
+    double nsPerPrimitive;
+    double mpixPerSecond;
+    double spread;
+};
+
+struct Case
+{
+    const char* name;
+    int bpp;
+    int size;
+    /* pixels covered by one primitive */
+    double pixels;
+    std::function<void(int)> draw;
+};
+
+SDL_Surface* createSurface(int w, int h, int bpp)
+{
+    SDL_Surface* surf = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, bpp, 0, 0, 0, 0);
+    if(!surf)
+    {
+        std::fprintf(stderr, "Could not create %dx%d@%d surface: %s\n", w, h, bpp, SDL_GetError());
+        std::exit(1);
+    }
+    if(bpp == 8)
+    {
+        std::array<SDL_Color, 256> colors;
+        for(int i = 0; i < 256; i++)
+            colors[i] = SDL_Color{Uint8(i), Uint8(255 - i), Uint8(i * 7), 0};
+        SDL_SetColors(surf, colors.data(), 0, 256);
+    }
+    return surf;
+}
+
+/* Deterministic noise texture, so every run rasterizes exactly the same data */
+void fillTexture(SDL_Surface* surf)
+{
+    Uint32 seed = 0x12345678;
+    for(int y = 0; y < surf->h; y++)
+    {
+        for(int x = 0; x < surf->w; x++)
+        {
+            seed = seed * 1664525 + 1013904223;
+            sge_PutPixel(surf, Sint16(x), Sint16(y), SDL_MapRGB(surf->format, Uint8(seed >> 24), Uint8(seed >> 16), Uint8(seed >> 8)));
+        }
+    }
+}
+
+/* Positions the n-th primitive of a run inside the destination (no clipping) */
+Sint16 posX(int n, int size)
+{
+    return Sint16((n * 37) % (SURFACE_SIZE - size));
+}
+Sint16 posY(int n, int size)
+{
+    return Sint16((n * 91) % (SURFACE_SIZE - size));
+}
+
+Result runCase(const Case& c, int repetitions)
+{
+    const int count = primitivesPerRun(c.size);
+    std::vector<double> runs;
+
+    /* one warm up run to fill the caches */
+    c.draw(count);
+    for(int i = 0; i < repetitions; i++)
+    {
+        const auto start = Clock::now();
+        c.draw(count);
+        const std::chrono::duration<double, std::nano> duration = Clock::now() - start;
+        runs.push_back(duration.count() / count);
+    }
+    std::sort(runs.begin(), runs.end());
+    const double median = runs[runs.size() / 2];
+    return Result{median, c.pixels / median * 1e3, (runs.back() - runs.front()) / median};
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const int repetitions = (argc > 1) ? std::max(1, std::atoi(argv[1])) : 9;
+
+    if(SDL_Init(0) < 0)
+    {
+        std::fprintf(stderr, "Could not init SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+    // no locking/updating needed for software surfaces
+    sge_Update_OFF();
+    sge_Lock_OFF();
+
+    static Uint8 preCalcPalettes[256][256];
+    for(int i = 0; i < 256; i++)
+        for(int j = 0; j < 256; j++)
+            preCalcPalettes[i][j] = Uint8((i * j) >> 8);
+
+    std::vector<Case> cases;
+    std::vector<SDL_Surface*> surfaces;
+
+    for(int bpp : {8, 16, 32})
+    {
+        SDL_Surface* dest = createSurface(SURFACE_SIZE, SURFACE_SIZE, bpp);
+        SDL_Surface* tex = createSurface(TEXTURE_SIZE, TEXTURE_SIZE, bpp);
+        fillTexture(tex);
+        surfaces.push_back(dest);
+        surfaces.push_back(tex);
+
+        Uint32 keys[] = {SDL_MapRGB(tex->format, 0, 0, 0), SDL_MapRGB(tex->format, 255, 0, 255)};
+
+        for(int size : {8, 32, 128})
+        {
+            const Sint16 s = Sint16(size);
+            const Sint16 ts = Sint16(std::min(size, TEXTURE_SIZE - 1));
+            const double trigonPixels = size * size / 2.;
+
+            cases.push_back(Case{"TexturedTrigon", bpp, size, trigonPixels, [=](int count) {
+                                     for(int n = 0; n < count; n++)
+                                     {
+                                         const Sint16 x = posX(n, size), y = posY(n, size);
+                                         sge_TexturedTrigon(dest, x, y, x + s, y, x, y + s, tex, 0, 0, ts, 0, 0, ts);
+                                     }
+                                 }});
+            cases.push_back(Case{"FadedTexturedTrigon", bpp, size, trigonPixels, [=](int count) {
+                                     for(int n = 0; n < count; n++)
+                                     {
+                                         const Sint16 x = posX(n, size), y = posY(n, size);
+                                         sge_FadedTexturedTrigon(dest, x, y, x + s, y, x, y + s, tex, 0, 0, ts, 0, 0, ts, 1 << 15, 1 << 16,
+                                                                 3 << 15);
+                                     }
+                                 }});
+            cases.push_back(Case{"FadedTexturedTrigonColorKeys", bpp, size, trigonPixels, [=](int count) mutable {
+                                     for(int n = 0; n < count; n++)
+                                     {
+                                         const Sint16 x = posX(n, size), y = posY(n, size);
+                                         sge_FadedTexturedTrigonColorKeys(dest, x, y, x + s, y, x, y + s, tex, 0, 0, ts, 0, 0, ts, 1 << 15,
+                                                                          1 << 16, 3 << 15, keys, 2);
+                                     }
+                                 }});
+            cases.push_back(Case{"PreCalcFadedTexturedTrigon", bpp, size, trigonPixels, [=](int count) {
+                                     for(int n = 0; n < count; n++)
+                                     {
+                                         const Sint16 x = posX(n, size), y = posY(n, size);
+                                         sge_PreCalcFadedTexturedTrigon(dest, x, y, x + s, y, x, y + s, tex, 0, 0, ts, 0, 0, ts, 0x4000,
+                                                                        0x8000, 0xC000, preCalcPalettes);
+                                     }
+                                 }});
+            cases.push_back(Case{"PreCalcFadedTexturedTrigonColorKeys", bpp, size, trigonPixels, [=](int count) mutable {
+                                     for(int n = 0; n < count; n++)
+                                     {
+                                         const Sint16 x = posX(n, size), y = posY(n, size);
+                                         sge_PreCalcFadedTexturedTrigonColorKeys(dest, x, y, x + s, y, x, y + s, tex, 0, 0, ts, 0, 0, ts,
+                                                                                 0x4000, 0x8000, 0xC000, preCalcPalettes, keys, 2);
+                                     }
+                                 }});
+            cases.push_back(Case{"TexturedRect", bpp, size, double(size * size), [=](int count) {
+                                     for(int n = 0; n < count; n++)
+                                     {
+                                         const Sint16 x = posX(n, size), y = posY(n, size);
+                                         sge_TexturedRect(dest, x, y, x + s, y, x, y + s, x + s, y + s, tex, 0, 0, ts, 0, 0, ts, ts, ts);
+                                     }
+                                 }});
+            cases.push_back(Case{"BlitTransparent", bpp, size, double(size * size), [=](int count) {
+                                     for(int n = 0; n < count; n++)
+                                     {
+                                         const Sint16 x = posX(n, size), y = posY(n, size);
+                                         sge_BlitTransparent(tex, dest, 0, 0, x, y, ts, ts, keys[0], SDL_ALPHA_OPAQUE);
+                                     }
+                                 }});
+            cases.push_back(Case{"transform (rotate 30)", bpp, size, double(size * size), [=](int count) {
+                                     const float scale = float(size) / TEXTURE_SIZE;
+                                     for(int n = 0; n < count; n++)
+                                     {
+                                         const Sint16 x = posX(n, size), y = posY(n, size);
+                                         sge_transform(tex, dest, 30.f, scale, scale, TEXTURE_SIZE / 2, TEXTURE_SIZE / 2,
+                                                       Uint16(x + size / 2), Uint16(y + size / 2), 0);
+                                     }
+                                 }});
+        }
+    }
+
+    std::printf("%-38s %4s %5s %14s %10s %8s\n", "primitive", "bpp", "size", "ns/primitive", "Mpix/s", "spread");
+    for(const Case& c : cases)
+    {
+        const Result result = runCase(c, repetitions);
+        std::printf("%-38s %4d %5d %14.1f %10.1f %7.1f%%\n", c.name, c.bpp, c.size, result.nsPerPrimitive, result.mpixPerSecond,
+                    result.spread * 100);
+    }
+
+    for(SDL_Surface* surf : surfaces)
+        SDL_FreeSurface(surf);
+    SDL_Quit();
+    return 0;
+}
@@ -1873,6 +1873,297 @@ static void _FadedTexturedLineColorKeys(SDL_Surface* dest, Sint16 x1, Sint16 x2,
     }
 }
 
+//==================================================================================
+// Specialized textured line kernels
+//
+// The generic lines above decide per scanline how a pixel is read, shaded and written.
+// A trigon draws all of its scanlines with the same surfaces, so the trigon functions
+// select one of the kernels below once and call it for every line. Only the fast mode
+// (same bytes per pixel in source and destination, 8/16/32 bpp) is specialized, all
+// other combinations still use the generic lines.
+//==================================================================================
+
+/* Per trigon arguments of the kernels, not every variant uses all of them */
+struct TexturedLineArgs
+{
+    Uint8 (*PreCalcPalettes)[256];
+    const Uint32* keys;
+    int keycount;
+};
+
+template<typename T_Intensity>
+using TexturedLineFn = void (*)(SDL_Surface* dest, Sint16 x1, Sint16 x2, Sint16 y, SDL_Surface* source, Sint16 sx1, Sint16 sy1, Sint16 sx2,
+                                Sint16 sy2, T_Intensity i1, T_Intensity i2, const TexturedLineArgs& args);
+
+static bool isXRGB8888(const SDL_PixelFormat& format)
+{
+    return format.BytesPerPixel == 4 && format.Rmask == 0x00FF0000 && format.Gmask == 0x0000FF00 && format.Bmask == 0x000000FF
+           && format.Amask == 0;
+}
+
+/* Same as ScaleRGB() but with the shifts of the usual 32-bpp display format known at compile time */
+static inline Uint32 ScaleXRGB8888(Uint32 value, Sint32 factor)
+{
+    const auto r = (static_cast<Sint32>((value >> 16) & 0xFF) * factor) >> 16;
+    const auto g = (static_cast<Sint32>((value >> 8) & 0xFF) * factor) >> 16;
+    const auto b = (static_cast<Sint32>(value & 0xFF) * factor) >> 16;
+    const auto r8 = (Uint32)(r > 255 ? 255 : (r < 0 ? 0 : r));
+    const auto g8 = (Uint32)(g > 255 ? 255 : (g < 0 ? 0 : g));
+    const auto b8 = (Uint32)(b > 255 ? 255 : (b < 0 ? 0 : b));
+    return r8 << 16 | g8 << 8 | b8;
+}
+
+/* Pixel operations, they write the texel 'value' with intensity 'I' to 'pixel' */
+struct CopyPixel
+{
+    CopyPixel(const SDL_PixelFormat&, const SDL_PixelFormat&, const TexturedLineArgs&) {}
+    template<typename T_Pixel, typename T_Intensity>
+    void operator()(T_Pixel& pixel, T_Pixel value, T_Intensity) const
+    {
+        pixel = value;
+    }
+};
+
+struct CopyPixelColorKey
+{
+    const Uint32 colorkey;
+    CopyPixelColorKey(const SDL_PixelFormat&, const SDL_PixelFormat& srcFormat, const TexturedLineArgs&) : colorkey(srcFormat.colorkey) {}
+    template<typename T_Pixel, typename T_Intensity>
+    void operator()(T_Pixel& pixel, T_Pixel value, T_Intensity) const
+    {
+        if(value != colorkey)
+            pixel = value;
+    }
+};
+
+template<bool T_isXRGB8888, bool T_useColorKeys>
+struct ScalePixel
+{
+    const SDL_PixelFormat format;
+    const Uint32* keys;
+    const int keycount;
+    ScalePixel(const SDL_PixelFormat& dstFormat, const SDL_PixelFormat&, const TexturedLineArgs& args)
+        : format(dstFormat), keys(args.keys), keycount(args.keycount)
+    {}
+    template<typename T_Intensity>
+    void operator()(Uint32& pixel, Uint32 value, T_Intensity I) const
+    {
+        if(T_useColorKeys)
+        {
+            for(int i = 0; i < keycount; i++)
+            {
+                if(value == keys[i])
+                    return;
+            }
+        }
+        pixel = T_isXRGB8888 ? ScaleXRGB8888(value, I) : ScaleRGB(format, value, I);
+    }
+};
+
+template<bool T_useColorKeys>
+struct PreCalcPixel
+{
+    Uint8 (*const PreCalcPalettes)[256];
+    const Uint32* keys;
+    const int keycount;
+    PreCalcPixel(const SDL_PixelFormat&, const SDL_PixelFormat&, const TexturedLineArgs& args)
+        : PreCalcPalettes(args.PreCalcPalettes), keys(args.keys), keycount(args.keycount)
+    {}
+    void operator()(Uint8& pixel, Uint8 value, Uint16 I) const
+    {
+        if(T_useColorKeys)
+        {
+            for(int i = 0; i < keycount; i++)
+            {
+                if(value == (Uint8)keys[i])
+                    return;
+            }
+        }
+        pixel = PreCalcPalettes[(Uint8)(I >> 8)][value];
+    }
+};
+
+template<typename T_Pixel, class T_PixelOp, typename T_Intensity, typename T_IntensityStep>
+static void _FastTexturedLine(SDL_Surface* dest, Sint16 x1, Sint16 x2, Sint16 y, SDL_Surface* source, Sint16 sx1, Sint16 sy1, Sint16 sx2,
+                              Sint16 sy2, T_Intensity i1, T_Intensity i2, const TexturedLineArgs& args)
+{
+    Sint16 x;
+    T_Intensity i;
+
+    /* Fix coords */
+    if(x1 > x2)
+    {
+        SWAP(x1, x2, x);
+        SWAP(sx1, sx2, x);
+        SWAP(sy1, sy2, x);
+        SWAP(i1, i2, i);
+    }
+
+    /* We use fixedpoint math */
+    T_Intensity I = i1;
+
+    /* Color step value */
+    T_IntensityStep istep = (i2 - i1) / (x2 - x1 + 1);
+
+    /* Fixed point texture starting coords */
+    Sint32 srcx = sx1 << 16;
+    Sint32 srcy = sy1 << 16;
+
+    /* Texture coords stepping value */
+    Sint32 xstep = Sint32((sx2 - sx1) << 16) / Sint32(x2 - x1 + 1);
+    Sint32 ystep = Sint32((sy2 - sy1) << 16) / Sint32(x2 - x1 + 1);
+
+    /* Clipping */
+    if(x2 < sge_clip_xmin(dest) || x1 > sge_clip_xmax(dest) || y < sge_clip_ymin(dest) || y > sge_clip_ymax(dest))
+        return;
+    if(x1 < sge_clip_xmin(dest))
+    {
+        /* Update start colors */
+        I += (sge_clip_xmin(dest) - x1) * istep;
+        /* Fix texture starting coord */
+        srcx += (sge_clip_xmin(dest) - x1) * xstep;
+        srcy += (sge_clip_xmin(dest) - x1) * ystep;
+        x1 = sge_clip_xmin(dest);
+    }
+    if(x2 > sge_clip_xmax(dest))
+        x2 = sge_clip_xmax(dest);
+
+    const T_PixelOp op(*dest->format, *source->format, args);
+
+    auto* row = reinterpret_cast<T_Pixel*>(static_cast<Uint8*>(dest->pixels) + y * dest->pitch);
+    const auto* srcPixels = static_cast<const T_Pixel*>(source->pixels);
+    const Uint16 pitch = source->pitch / sizeof(T_Pixel);
+
+    for(x = x1; x <= x2; x++)
+    {
+        op(row[x], srcPixels[(srcy >> 16) * pitch + (srcx >> 16)], I);
+
+        I += istep;
+
+        srcx += xstep;
+        srcy += ystep;
+    }
+}
+
+/* Fallbacks to the generic lines with the signature of the kernels */
+static void _TexturedLineGeneric(SDL_Surface* dest, Sint16 x1, Sint16 x2, Sint16 y, SDL_Surface* source, Sint16 sx1, Sint16 sy1,
+                                 Sint16 sx2, Sint16 sy2, Sint32, Sint32, const TexturedLineArgs&)
+{
+    _TexturedLine(dest, x1, x2, y, source, sx1, sy1, sx2, sy2);
+}
+
+static void _FadedTexturedLineGeneric(SDL_Surface* dest, Sint16 x1, Sint16 x2, Sint16 y, SDL_Surface* source, Sint16 sx1, Sint16 sy1,
+                                      Sint16 sx2, Sint16 sy2, Sint32 i1, Sint32 i2, const TexturedLineArgs&)
+{
+    _FadedTexturedLine(dest, x1, x2, y, source, sx1, sy1, sx2, sy2, i1, i2);
+}
+
+static void _FadedTexturedLineColorKeysGeneric(SDL_Surface* dest, Sint16 x1, Sint16 x2, Sint16 y, SDL_Surface* source, Sint16 sx1,
+                                               Sint16 sy1, Sint16 sx2, Sint16 sy2, Sint32 i1, Sint32 i2, const TexturedLineArgs& args)
+{
+    _FadedTexturedLineColorKeys(dest, x1, x2, y, source, sx1, sy1, sx2, sy2, i1, i2, args.keys, args.keycount);
+}
+
+static void _PreCalcFadedTexturedLineGeneric(SDL_Surface* dest, Sint16 x1, Sint16 x2, Sint16 y, SDL_Surface* source, Sint16 sx1,
+                                             Sint16 sy1, Sint16 sx2, Sint16 sy2, Uint16 i1, Uint16 i2, const TexturedLineArgs& args)
+{
+    _PreCalcFadedTexturedLine(dest, x1, x2, y, source, sx1, sy1, sx2, sy2, i1, i2, args.PreCalcPalettes);
+}
+
+static void _PreCalcFadedTexturedLineColorKeysGeneric(SDL_Surface* dest, Sint16 x1, Sint16 x2, Sint16 y, SDL_Surface* source, Sint16 sx1,
+                                                      Sint16 sy1, Sint16 sx2, Sint16 sy2, Uint16 i1, Uint16 i2,
+                                                      const TexturedLineArgs& args)
+{
+    _PreCalcFadedTexturedLineColorKeys(dest, x1, x2, y, source, sx1, sy1, sx2, sy2, i1, i2, args.PreCalcPalettes, args.keys,
+                                       args.keycount);
+}
+
+/*
+ * Kernel selection. The chosen kernels do exactly what the fast mode of the matching
+ * generic line does for that bpp (e.g. 16-bpp is never shaded).
+ */
+static TexturedLineFn<Sint32> _selectTexturedLine(const SDL_Surface* dest, const SDL_Surface* source)
+{
+    if(dest->format->BytesPerPixel == source->format->BytesPerPixel)
+    {
+        switch(dest->format->BytesPerPixel)
+        {
+            case 1: return _FastTexturedLine<Uint8, CopyPixelColorKey, Sint32, Sint32>;
+            case 2: return _FastTexturedLine<Uint16, CopyPixel, Sint32, Sint32>;
+            case 4: return _FastTexturedLine<Uint32, CopyPixelColorKey, Sint32, Sint32>;
+        }
+    }
+    return _TexturedLineGeneric;
+}
+
+static TexturedLineFn<Sint32> _selectFadedTexturedLine(const SDL_Surface* dest, const SDL_Surface* source)
+{
+    if(dest->format->BytesPerPixel == source->format->BytesPerPixel)
+    {
+        switch(dest->format->BytesPerPixel)
+        {
+            case 1: return _FastTexturedLine<Uint8, CopyPixel, Sint32, Sint32>;
+            case 2: return _FastTexturedLine<Uint16, CopyPixel, Sint32, Sint32>;
+            case 4:
+                if(isXRGB8888(*dest->format))
+                    return _FastTexturedLine<Uint32, ScalePixel<true, false>, Sint32, Sint32>;
+                return _FastTexturedLine<Uint32, ScalePixel<false, false>, Sint32, Sint32>;
+        }
+    }
+    return _FadedTexturedLineGeneric;
+}
+
+static TexturedLineFn<Sint32> _selectFadedTexturedLineColorKeys(const SDL_Surface* dest, const SDL_Surface* source)
+{
+    if(dest->format->BytesPerPixel == source->format->BytesPerPixel)
+    {
+        switch(dest->format->BytesPerPixel)
+        {
+            case 1: return _FastTexturedLine<Uint8, CopyPixel, Sint32, Sint32>;
+            case 2: return _FastTexturedLine<Uint16, CopyPixel, Sint32, Sint32>;
+            case 4:
+                if(isXRGB8888(*dest->format))
+                    return _FastTexturedLine<Uint32, ScalePixel<true, true>, Sint32, Sint32>;
+                return _FastTexturedLine<Uint32, ScalePixel<false, true>, Sint32, Sint32>;
+        }
+    }
+    return _FadedTexturedLineColorKeysGeneric;
+}
+
+static TexturedLineFn<Uint16> _selectPreCalcFadedTexturedLine(const SDL_Surface* dest, const SDL_Surface* source)
+{
+    if(dest->format->BytesPerPixel == source->format->BytesPerPixel)
+    {
+        switch(dest->format->BytesPerPixel)
+        {
+            case 1: return _FastTexturedLine<Uint8, PreCalcPixel<false>, Uint16, Sint16>;
+            case 2: return _FastTexturedLine<Uint16, CopyPixel, Uint16, Sint16>;
+            case 4:
+                if(isXRGB8888(*dest->format))
+                    return _FastTexturedLine<Uint32, ScalePixel<true, false>, Uint16, Sint16>;
+                return _FastTexturedLine<Uint32, ScalePixel<false, false>, Uint16, Sint16>;
+        }
+    }
+    return _PreCalcFadedTexturedLineGeneric;
+}
+
+static TexturedLineFn<Uint16> _selectPreCalcFadedTexturedLineColorKeys(const SDL_Surface* dest, const SDL_Surface* source)
+{
+    if(dest->format->BytesPerPixel == source->format->BytesPerPixel)
+    {
+        switch(dest->format->BytesPerPixel)
+        {
+            case 1: return _FastTexturedLine<Uint8, PreCalcPixel<true>, Uint16, Sint16>;
+            case 2: return _FastTexturedLine<Uint16, CopyPixel, Uint16, Sint16>;
+            case 4:
+                if(isXRGB8888(*dest->format))
+                    return _FastTexturedLine<Uint32, ScalePixel<true, false>, Uint16, Sint16>;
+                return _FastTexturedLine<Uint32, ScalePixel<false, false>, Uint16, Sint16>;
+        }
+    }
+    return _PreCalcFadedTexturedLineColorKeysGeneric;
+}
+
 void sge_TexturedLine(SDL_Surface* dest, Sint16 x1, Sint16 x2, Sint16 y, SDL_Surface* source, Sint16 sx1, Sint16 sy1, Sint16 sx2,
                       Sint16 sy2)
 {
@@ -2477,6 +2768,9 @@ void sge_TexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2, Sint
     Sint32 ystep2 = Sint32((sy3 - sy1) << 16) / Sint32(y3 - y1);
     Sint32 ystep3 = 0;
 
+    const auto drawLine = _selectTexturedLine(dest, source);
+    const TexturedLineArgs args{nullptr, nullptr, 0};
+
     if(SDL_MUSTLOCK(dest) && _sge_lock)
         if(SDL_LockSurface(dest) < 0)
             return;
@@ -2486,7 +2780,7 @@ void sge_TexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2, Sint
 
     /* Upper half of the triangle */
     if(y1 == y2)
-        _TexturedLine(dest, x1, x2, y1, source, sx1, sy1, sx2, sy2);
+        drawLine(dest, x1, x2, y1, source, sx1, sy1, sx2, sy2, 0, 0, args);
     else
     {
         m1 = Sint32((x2 - x1) << 16) / Sint32(y2 - y1);
@@ -2496,7 +2790,7 @@ void sge_TexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2, Sint
 
         for(y = y1; y <= y2; y++)
         {
-            _TexturedLine(dest, xa >> 16, xb >> 16, y, source, srcx1 >> 16, srcy1 >> 16, srcx2 >> 16, srcy2 >> 16);
+            drawLine(dest, xa >> 16, xb >> 16, y, source, srcx1 >> 16, srcy1 >> 16, srcx2 >> 16, srcy2 >> 16, 0, 0, args);
 
             xa += m1;
             xb += m2;
@@ -2510,7 +2804,7 @@ void sge_TexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2, Sint
 
     /* Lower half of the triangle */
     if(y2 == y3)
-        _TexturedLine(dest, x2, x3, y2, source, sx2, sy2, sx3, sy3);
+        drawLine(dest, x2, x3, y2, source, sx2, sy2, sx3, sy3, 0, 0, args);
     else
     {
         m3 = Sint32((x3 - x2) << 16) / Sint32(y3 - y2);
@@ -2520,7 +2814,7 @@ void sge_TexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2, Sint
 
         for(y = y2 + 1; y <= y3; y++)
         {
-            _TexturedLine(dest, xb >> 16, xc >> 16, y, source, srcx2 >> 16, srcy2 >> 16, srcx3 >> 16, srcy3 >> 16);
+            drawLine(dest, xb >> 16, xc >> 16, y, source, srcx2 >> 16, srcy2 >> 16, srcx3 >> 16, srcy3 >> 16, 0, 0, args);
 
             xb += m2;
             xc += m3;
@@ -2636,6 +2930,9 @@ void sge_FadedTexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2,
     Sint32 ystep2 = Sint32((sy3 - sy1) << 16) / Sint32(y3 - y1);
     Sint32 ystep3 = 0;
 
+    const auto drawLine = _selectFadedTexturedLine(dest, source);
+    const TexturedLineArgs args{nullptr, nullptr, 0};
+
     if(SDL_MUSTLOCK(dest) && _sge_lock)
         if(SDL_LockSurface(dest) < 0)
             return;
@@ -2647,7 +2944,7 @@ void sge_FadedTexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2,
     if(y1 == y2)
         //_TexturedLine(dest,x1,x2,y1,source,sx1,sy1,sx2,sy2);
         //_FadedLine(dest, x1, x2, y1, col1.r, col1.g, col1.b, col2.r, col2.g, col2.b);
-        _FadedTexturedLine(dest, x1, x2, y1, source, sx1, sy1, sx2, sy2, i_orig1, i_orig2);
+        drawLine(dest, x1, x2, y1, source, sx1, sy1, sx2, sy2, i_orig1, i_orig2, args);
     else
     {
         m1 = Sint32((x2 - x1) << 16) / Sint32(y2 - y1);
@@ -2661,7 +2958,7 @@ void sge_FadedTexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2,
         {
             //_TexturedLine(dest, xa>>16, xb>>16, y, source, srcx1>>16, srcy1>>16, srcx2>>16, srcy2>>16);
             //_FadedLine(dest, xa>>16, xb>>16, y, r1>>16, g1>>16, b1>>16, r2>>16, g2>>16, b2>>16);
-            _FadedTexturedLine(dest, xa >> 16, xb >> 16, y, source, srcx1 >> 16, srcy1 >> 16, srcx2 >> 16, srcy2 >> 16, i1, i2);
+            drawLine(dest, xa >> 16, xb >> 16, y, source, srcx1 >> 16, srcy1 >> 16, srcx2 >> 16, srcy2 >> 16, i1, i2, args);
 
             xa += m1;
             xb += m2;
@@ -2681,7 +2978,7 @@ void sge_FadedTexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2,
     if(y2 == y3)
         //_TexturedLine(dest,x2,x3,y2,source,sx2,sy2,sx3,sy3);
         //_FadedLine(dest, x2, x3, y2, col2.r, col2.g, col2.b, col3.r, col3.g, col3.b);
-        _FadedTexturedLine(dest, x2, x3, y2, source, sx2, sy2, sx3, sy3, i_orig2, i_orig3);
+        drawLine(dest, x2, x3, y2, source, sx2, sy2, sx3, sy3, i_orig2, i_orig3, args);
     else
     {
         m3 = Sint32((x3 - x2) << 16) / Sint32(y3 - y2);
@@ -2695,7 +2992,7 @@ void sge_FadedTexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2,
         {
             //_TexturedLine(dest, xb>>16, xc>>16, y, source, srcx2>>16, srcy2>>16, srcx3>>16, srcy3>>16);
             //_FadedLine(dest, xb>>16, xc>>16, y, r2>>16, g2>>16, b2>>16, r3>>16, g3>>16, b3>>16);
-            _FadedTexturedLine(dest, xb >> 16, xc >> 16, y, source, srcx2 >> 16, srcy2 >> 16, srcx3 >> 16, srcy3 >> 16, i2, i3);
+            drawLine(dest, xb >> 16, xc >> 16, y, source, srcx2 >> 16, srcy2 >> 16, srcx3 >> 16, srcy3 >> 16, i2, i3, args);
 
             xb += m2;
             xc += m3;
@@ -2816,6 +3113,9 @@ void sge_PreCalcFadedTexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sin
     Sint32 ystep2 = Sint32((sy3 - sy1) << 16) / Sint32(y3 - y1);
     Sint32 ystep3 = 0;
 
+    const auto drawLine = _selectPreCalcFadedTexturedLine(dest, source);
+    const TexturedLineArgs args{PreCalcPalettes, nullptr, 0};
+
     if(SDL_MUSTLOCK(dest) && _sge_lock)
         if(SDL_LockSurface(dest) < 0)
             return;
@@ -2827,7 +3127,7 @@ void sge_PreCalcFadedTexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sin
     if(y1 == y2)
         //_TexturedLine(dest,x1,x2,y1,source,sx1,sy1,sx2,sy2);
         //_FadedLine(dest, x1, x2, y1, col1.r, col1.g, col1.b, col2.r, col2.g, col2.b);
-        _PreCalcFadedTexturedLine(dest, x1, x2, y1, source, sx1, sy1, sx2, sy2, i_orig1, i_orig2, PreCalcPalettes);
+        drawLine(dest, x1, x2, y1, source, sx1, sy1, sx2, sy2, i_orig1, i_orig2, args);
     else
     {
         m1 = Sint32((x2 - x1) << 16) / Sint32(y2 - y1);
@@ -2841,8 +3141,7 @@ void sge_PreCalcFadedTexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sin
         {
             //_TexturedLine(dest, xa>>16, xb>>16, y, source, srcx1>>16, srcy1>>16, srcx2>>16, srcy2>>16);
             //_FadedLine(dest, xa>>16, xb>>16, y, r1>>16, g1>>16, b1>>16, r2>>16, g2>>16, b2>>16);
-            _PreCalcFadedTexturedLine(dest, xa >> 16, xb >> 16, y, source, srcx1 >> 16, srcy1 >> 16, srcx2 >> 16, srcy2 >> 16, i1, i2,
-                                      PreCalcPalettes);
+            drawLine(dest, xa >> 16, xb >> 16, y, source, srcx1 >> 16, srcy1 >> 16, srcx2 >> 16, srcy2 >> 16, i1, i2, args);
 
             // if (i1 < 0 || i2 < 0)
             // printf("\nx1:%d y1:%d x2:%d y2:%d x3:%d y3:%d i1>>8:%d i2>>8:%d istep1:%d istep2:%d I1>>8:%d I2>>8:%d I3>>8:%d", x1, y1, x2,
@@ -2866,7 +3165,7 @@ void sge_PreCalcFadedTexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sin
     if(y2 == y3)
         //_TexturedLine(dest,x2,x3,y2,source,sx2,sy2,sx3,sy3);
         //_FadedLine(dest, x2, x3, y2, col2.r, col2.g, col2.b, col3.r, col3.g, col3.b);
-        _PreCalcFadedTexturedLine(dest, x2, x3, y2, source, sx2, sy2, sx3, sy3, i_orig2, i_orig3, PreCalcPalettes);
+        drawLine(dest, x2, x3, y2, source, sx2, sy2, sx3, sy3, i_orig2, i_orig3, args);
     else
     {
         m3 = Sint32((x3 - x2) << 16) / Sint32(y3 - y2);
@@ -2880,8 +3179,7 @@ void sge_PreCalcFadedTexturedTrigon(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sin
         {
             //_TexturedLine(dest, xb>>16, xc>>16, y, source, srcx2>>16, srcy2>>16, srcx3>>16, srcy3>>16);
             //_FadedLine(dest, xb>>16, xc>>16, y, r2>>16, g2>>16, b2>>16, r3>>16, g3>>16, b3>>16);
-            _PreCalcFadedTexturedLine(dest, xb >> 16, xc >> 16, y, source, srcx2 >> 16, srcy2 >> 16, srcx3 >> 16, srcy3 >> 16, i2, i3,
-                                      PreCalcPalettes);
+            drawLine(dest, xb >> 16, xc >> 16, y, source, srcx2 >> 16, srcy2 >> 16, srcx3 >> 16, srcy3 >> 16, i2, i3, args);
 
             xb += m2;
             xc += m3;
@@ -3002,6 +3300,9 @@ void sge_FadedTexturedTrigonColorKeys(SDL_Surface* dest, Sint16 x1, Sint16 y1, S
     Sint32 ystep2 = Sint32((sy3 - sy1) << 16) / Sint32(y3 - y1);
     Sint32 ystep3 = 0;
 
+    const auto drawLine = _selectFadedTexturedLineColorKeys(dest, source);
+    const TexturedLineArgs args{nullptr, keys, keycount};
+
     if(SDL_MUSTLOCK(dest) && _sge_lock)
         if(SDL_LockSurface(dest) < 0)
             return;
@@ -3013,7 +3314,7 @@ void sge_FadedTexturedTrigonColorKeys(SDL_Surface* dest, Sint16 x1, Sint16 y1, S
     if(y1 == y2)
         //_TexturedLine(dest,x1,x2,y1,source,sx1,sy1,sx2,sy2);
         //_FadedLine(dest, x1, x2, y1, col1.r, col1.g, col1.b, col2.r, col2.g, col2.b);
-        _FadedTexturedLineColorKeys(dest, x1, x2, y1, source, sx1, sy1, sx2, sy2, i_orig1, i_orig2, keys, keycount);
+        drawLine(dest, x1, x2, y1, source, sx1, sy1, sx2, sy2, i_orig1, i_orig2, args);
     else
     {
         m1 = Sint32((x2 - x1) << 16) / Sint32(y2 - y1);
@@ -3027,8 +3328,7 @@ void sge_FadedTexturedTrigonColorKeys(SDL_Surface* dest, Sint16 x1, Sint16 y1, S
         {
             //_TexturedLine(dest, xa>>16, xb>>16, y, source, srcx1>>16, srcy1>>16, srcx2>>16, srcy2>>16);
             //_FadedLine(dest, xa>>16, xb>>16, y, r1>>16, g1>>16, b1>>16, r2>>16, g2>>16, b2>>16);
-            _FadedTexturedLineColorKeys(dest, xa >> 16, xb >> 16, y, source, srcx1 >> 16, srcy1 >> 16, srcx2 >> 16, srcy2 >> 16, i1, i2,
-                                        keys, keycount);
+            drawLine(dest, xa >> 16, xb >> 16, y, source, srcx1 >> 16, srcy1 >> 16, srcx2 >> 16, srcy2 >> 16, i1, i2, args);
 
             xa += m1;
             xb += m2;
@@ -3048,7 +3348,7 @@ void sge_FadedTexturedTrigonColorKeys(SDL_Surface* dest, Sint16 x1, Sint16 y1, S
     if(y2 == y3)
         //_TexturedLine(dest,x2,x3,y2,source,sx2,sy2,sx3,sy3);
         //_FadedLine(dest, x2, x3, y2, col2.r, col2.g, col2.b, col3.r, col3.g, col3.b);
-        _FadedTexturedLineColorKeys(dest, x2, x3, y2, source, sx2, sy2, sx3, sy3, i_orig2, i_orig3, keys, keycount);
+        drawLine(dest, x2, x3, y2, source, sx2, sy2, sx3, sy3, i_orig2, i_orig3, args);
     else
     {
         m3 = Sint32((x3 - x2) << 16) / Sint32(y3 - y2);
@@ -3062,8 +3362,7 @@ void sge_FadedTexturedTrigonColorKeys(SDL_Surface* dest, Sint16 x1, Sint16 y1, S
         {
             //_TexturedLine(dest, xb>>16, xc>>16, y, source, srcx2>>16, srcy2>>16, srcx3>>16, srcy3>>16);
             //_FadedLine(dest, xb>>16, xc>>16, y, r2>>16, g2>>16, b2>>16, r3>>16, g3>>16, b3>>16);
-            _FadedTexturedLineColorKeys(dest, xb >> 16, xc >> 16, y, source, srcx2 >> 16, srcy2 >> 16, srcx3 >> 16, srcy3 >> 16, i2, i3,
-                                        keys, keycount);
+            drawLine(dest, xb >> 16, xc >> 16, y, source, srcx2 >> 16, srcy2 >> 16, srcx3 >> 16, srcy3 >> 16, i2, i3, args);
 
             xb += m2;
             xc += m3;
@@ -3184,6 +3483,9 @@ void sge_PreCalcFadedTexturedTrigonColorKeys(SDL_Surface* dest, Sint16 x1, Sint1
     Sint32 ystep2 = Sint32((sy3 - sy1) << 16) / Sint32(y3 - y1);
     Sint32 ystep3 = 0;
 
+    const auto drawLine = _selectPreCalcFadedTexturedLineColorKeys(dest, source);
+    const TexturedLineArgs args{PreCalcPalettes, keys, keycount};
+
     if(SDL_MUSTLOCK(dest) && _sge_lock)
         if(SDL_LockSurface(dest) < 0)
             return;
@@ -3195,7 +3497,7 @@ void sge_PreCalcFadedTexturedTrigonColorKeys(SDL_Surface* dest, Sint16 x1, Sint1
     if(y1 == y2)
         //_TexturedLine(dest,x1,x2,y1,source,sx1,sy1,sx2,sy2);
         //_FadedLine(dest, x1, x2, y1, col1.r, col1.g, col1.b, col2.r, col2.g, col2.b);
-        _PreCalcFadedTexturedLineColorKeys(dest, x1, x2, y1, source, sx1, sy1, sx2, sy2, i_orig1, i_orig2, PreCalcPalettes, keys, keycount);
+        drawLine(dest, x1, x2, y1, source, sx1, sy1, sx2, sy2, i_orig1, i_orig2, args);
     else
     {
         m1 = Sint32((x2 - x1) << 16) / Sint32(y2 - y1);
@@ -3209,8 +3511,7 @@ void sge_PreCalcFadedTexturedTrigonColorKeys(SDL_Surface* dest, Sint16 x1, Sint1
         {
             //_TexturedLine(dest, xa>>16, xb>>16, y, source, srcx1>>16, srcy1>>16, srcx2>>16, srcy2>>16);
             //_FadedLine(dest, xa>>16, xb>>16, y, r1>>16, g1>>16, b1>>16, r2>>16, g2>>16, b2>>16);
-            _PreCalcFadedTexturedLineColorKeys(dest, xa >> 16, xb >> 16, y, source, srcx1 >> 16, srcy1 >> 16, srcx2 >> 16, srcy2 >> 16, i1,
-                                               i2, PreCalcPalettes, keys, keycount);
+            drawLine(dest, xa >> 16, xb >> 16, y, source, srcx1 >> 16, srcy1 >> 16, srcx2 >> 16, srcy2 >> 16, i1, i2, args);
 
             xa += m1;
             xb += m2;
@@ -3230,7 +3531,7 @@ void sge_PreCalcFadedTexturedTrigonColorKeys(SDL_Surface* dest, Sint16 x1, Sint1
     if(y2 == y3)
         //_TexturedLine(dest,x2,x3,y2,source,sx2,sy2,sx3,sy3);
         //_FadedLine(dest, x2, x3, y2, col2.r, col2.g, col2.b, col3.r, col3.g, col3.b);
-        _PreCalcFadedTexturedLineColorKeys(dest, x2, x3, y2, source, sx2, sy2, sx3, sy3, i_orig2, i_orig3, PreCalcPalettes, keys, keycount);
+        drawLine(dest, x2, x3, y2, source, sx2, sy2, sx3, sy3, i_orig2, i_orig3, args);
     else
     {
         m3 = Sint32((x3 - x2) << 16) / Sint32(y3 - y2);
@@ -3244,8 +3545,7 @@ void sge_PreCalcFadedTexturedTrigonColorKeys(SDL_Surface* dest, Sint16 x1, Sint1
         {
             //_TexturedLine(dest, xb>>16, xc>>16, y, source, srcx2>>16, srcy2>>16, srcx3>>16, srcy3>>16);
             //_FadedLine(dest, xb>>16, xc>>16, y, r2>>16, g2>>16, b2>>16, r3>>16, g3>>16, b3>>16);
-            _PreCalcFadedTexturedLineColorKeys(dest, xb >> 16, xc >> 16, y, source, srcx2 >> 16, srcy2 >> 16, srcx3 >> 16, srcy3 >> 16, i2,
-                                               i3, PreCalcPalettes, keys, keycount);
+            drawLine(dest, xb >> 16, xc >> 16, y, source, srcx2 >> 16, srcy2 >> 16, srcx3 >> 16, srcy3 >> 16, i2, i3, args);
 
             xb += m2;
             xc += m3;
@@ -3369,13 +3669,16 @@ void sge_TexturedRect(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2, Sint16
     Sint32 ystep3 = Sint32((sy4 - sy2) << 16) / Sint32(y4 - y2);
     Sint32 ystep4 = 0;
 
+    const auto drawLine = _selectTexturedLine(dest, source);
+    const TexturedLineArgs args{nullptr, nullptr, 0};
+
     if(SDL_MUSTLOCK(dest) && _sge_lock)
         if(SDL_LockSurface(dest) < 0)
             return;
 
     /* Upper bit of the rectangle */
     if(y1 == y2)
-        _TexturedLine(dest, x1, x2, y1, source, sx1, sy1, sx2, sy2);
+        drawLine(dest, x1, x2, y1, source, sx1, sy1, sx2, sy2, 0, 0, args);
     else
     {
         m1 = Sint32((x2 - x1) << 16) / Sint32(y2 - y1);
@@ -3385,7 +3688,7 @@ void sge_TexturedRect(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2, Sint16
 
         for(y = y1; y <= y2; y++)
         {
-            _TexturedLine(dest, xa >> 16, xb >> 16, y, source, srcx1 >> 16, srcy1 >> 16, srcx2 >> 16, srcy2 >> 16);
+            drawLine(dest, xa >> 16, xb >> 16, y, source, srcx1 >> 16, srcy1 >> 16, srcx2 >> 16, srcy2 >> 16, 0, 0, args);
 
             xa += m1;
             xb += m2;
@@ -3400,7 +3703,7 @@ void sge_TexturedRect(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2, Sint16
     /* Middle bit of the rectangle */
     for(y = y2 + 1; y <= y3; y++)
     {
-        _TexturedLine(dest, xb >> 16, xc >> 16, y, source, srcx2 >> 16, srcy2 >> 16, srcx3 >> 16, srcy3 >> 16);
+        drawLine(dest, xb >> 16, xc >> 16, y, source, srcx2 >> 16, srcy2 >> 16, srcx3 >> 16, srcy3 >> 16, 0, 0, args);
 
         xb += m2;
         xc += m3;
@@ -3413,7 +3716,7 @@ void sge_TexturedRect(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2, Sint16
 
     /* Lower bit of the rectangle */
     if(y3 == y4)
-        _TexturedLine(dest, x3, x4, y3, source, sx3, sy3, sx4, sy4);
+        drawLine(dest, x3, x4, y3, source, sx3, sy3, sx4, sy4, 0, 0, args);
     else
     {
         m4 = Sint32((x4 - x3) << 16) / Sint32(y4 - y3);
@@ -3423,7 +3726,7 @@ void sge_TexturedRect(SDL_Surface* dest, Sint16 x1, Sint16 y1, Sint16 x2, Sint16
 
         for(y = y3 + 1; y <= y4; y++)
         {
-            _TexturedLine(dest, xc >> 16, xd >> 16, y, source, srcx3 >> 16, srcy3 >> 16, srcx4 >> 16, srcy4 >> 16);
+            drawLine(dest, xc >> 16, xd >> 16, y, source, srcx3 >> 16, srcy3 >> 16, srcx4 >> 16, srcy4 >> 16, 0, 0, args);
 
             xc += m3;
             xd += m4;
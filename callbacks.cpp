@@ -16,6 +16,7 @@
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
 #include <algorithm>
+#include <cmath>
 
 namespace bfs = boost::filesystem;
 
@@ -658,6 +659,8 @@ void callback::EditorHelpMenu(int Param)
                 SelectBoxHelp->setOption("Zoom in/normal/out "
                                          "(experimental)..............................................................F5/F6/"
                                          "F7\n");
+                SelectBoxHelp->setOption(
+                  "Zoomed out view 1/4, 1/16, 1/64..................................................................F8\n");
                 SelectBoxHelp->setOption("Scroll..........................................................................................."
                                          "..................Arrow keys\n");
                 SelectBoxHelp->setOption(
@@ -754,6 +757,7 @@ void callback::EditorMainMenu(int Param)
     {
         LOADMENU,
         SAVEMENU,
+        LIGHTMENU,
         QUITMENU,
         WINDOWQUIT
     };
@@ -769,6 +773,7 @@ void callback::EditorMainMenu(int Param)
             {
                 WNDMain->addButton(EditorMainMenu, LOADMENU, 8, 100, 190, 20, BUTTON_GREEN2, "Load map");
                 WNDMain->addButton(EditorMainMenu, SAVEMENU, 8, 125, 190, 20, BUTTON_GREEN2, "Save map");
+                WNDMain->addButton(EditorMainMenu, LIGHTMENU, 8, 150, 190, 20, BUTTON_GREEN2, "Light");
 
                 WNDMain->addButton(EditorMainMenu, QUITMENU, 8, 260, 190, 20, BUTTON_GREEN2, "Leave editor");
             } else
@@ -801,6 +806,8 @@ void callback::EditorMainMenu(int Param)
 
         case SAVEMENU: EditorSaveMenu(INITIALIZING_CALL); break;
 
+        case LIGHTMENU: EditorLightMenu(INITIALIZING_CALL); break;
+
         default: break;
     }
 }
@@ -1043,6 +1050,7 @@ void callback::EditorQuitMenu(int Param)
             EditorAnimalMenu(MAP_QUIT);
             EditorPlayerMenu(MAP_QUIT);
             EditorCreateMenu(MAP_QUIT);
+            EditorLightMenu(MAP_QUIT);
             // go to main menu
             mainmenu(INITIALIZING_CALL);
             break;
@@ -2316,6 +2324,150 @@ void callback::EditorCursorMenu(int Param)
     }
 }
 
+//"light" menu: direction and strength of the light, applied to the whole map (in preview mode to the visible part first)
+void callback::EditorLightMenu(int Param)
+{
+    static CWindow* WNDLight = nullptr;
+    static CFont* TextDirection = nullptr;
+    static CFont* TextHeight = nullptr;
+    static CFont* TextAmbient = nullptr;
+    static CFont* TextDiffuse = nullptr;
+    static CFont* TextBpp = nullptr;
+    static CButton* ButtonPreview = nullptr;
+    static bool preview = true;
+    static int PosX = global::s2->GameResolution.x / 2 - 125, PosY = global::s2->GameResolution.y / 2 - 130;
+    // the direction is turned in steps of 15 degrees
+    const float rotation = 15 * 3.14159265f / 180;
+
+    enum
+    {
+        ROTATE_LEFT,
+        ROTATE_RIGHT,
+        REDUCE_HEIGHT,
+        RAISE_HEIGHT,
+        REDUCE_AMBIENT,
+        RAISE_AMBIENT,
+        REDUCE_DIFFUSE,
+        RAISE_DIFFUSE,
+        TOGGLE_PREVIEW,
+        RESET,
+        WINDOWQUIT
+    };
+
+    if(Param != INITIALIZING_CALL && Param != MAP_QUIT)
+        assert(WNDLight);
+
+    LightSettings light = CSurface::getLight();
+    bool lightChanged = true;
+
+    switch(Param)
+    {
+        case INITIALIZING_CALL:
+            lightChanged = false;
+            if(WNDLight)
+                break;
+            WNDLight = new CWindow(EditorLightMenu, WINDOWQUIT, PosX, PosY, 250, 260, "Light", WINDOW_GREEN1,
+                                   WINDOW_CLOSE | WINDOW_MOVE | WINDOW_MINIMIZE);
+            if(global::s2->RegisterWindow(WNDLight))
+            {
+                WNDLight->addText("Direction", 90, 4, 9, FONT_YELLOW);
+                WNDLight->addButton(EditorLightMenu, ROTATE_LEFT, 45, 15, 35, 20, BUTTON_GREY, "<-");
+                WNDLight->addButton(EditorLightMenu, ROTATE_RIGHT, 158, 15, 35, 20, BUTTON_GREY, "->");
+                WNDLight->addText("Height", 100, 40, 9, FONT_YELLOW);
+                WNDLight->addButton(EditorLightMenu, REDUCE_HEIGHT, 45, 51, 35, 20, BUTTON_GREY, "-");
+                WNDLight->addButton(EditorLightMenu, RAISE_HEIGHT, 158, 51, 35, 20, BUTTON_GREY, "+");
+                WNDLight->addText("Ambient", 95, 76, 9, FONT_YELLOW);
+                WNDLight->addButton(EditorLightMenu, REDUCE_AMBIENT, 45, 87, 35, 20, BUTTON_GREY, "-");
+                WNDLight->addButton(EditorLightMenu, RAISE_AMBIENT, 158, 87, 35, 20, BUTTON_GREY, "+");
+                WNDLight->addText("Diffuse", 97, 112, 9, FONT_YELLOW);
+                WNDLight->addButton(EditorLightMenu, REDUCE_DIFFUSE, 45, 123, 35, 20, BUTTON_GREY, "-");
+                WNDLight->addButton(EditorLightMenu, RAISE_DIFFUSE, 158, 123, 35, 20, BUTTON_GREY, "+");
+                ButtonPreview = WNDLight->addButton(EditorLightMenu, TOGGLE_PREVIEW, 44, 160, 150, 20, BUTTON_GREY,
+                                                    preview ? "Preview: on" : "Preview: off");
+                WNDLight->addButton(EditorLightMenu, RESET, 44, 190, 150, 20, BUTTON_GREY, "Reset");
+            } else
+            {
+                delete WNDLight;
+                WNDLight = nullptr;
+                return;
+            }
+            break;
+
+        case ROTATE_LEFT:
+        case ROTATE_RIGHT:
+        {
+            const float angle = (Param == ROTATE_LEFT ? -rotation : rotation);
+            const float x = light.direction.x, y = light.direction.y;
+            light.direction.x = x * std::cos(angle) - y * std::sin(angle);
+            light.direction.y = x * std::sin(angle) + y * std::cos(angle);
+            break;
+        }
+        case REDUCE_HEIGHT: light.direction.z = std::max(light.direction.z - 0.5f, -20.f); break;
+        case RAISE_HEIGHT: light.direction.z = std::min(light.direction.z + 0.5f, 20.f); break;
+        case REDUCE_AMBIENT: light.ambient = std::max(light.ambient - 0.05f, 0.f); break;
+        case RAISE_AMBIENT: light.ambient = std::min(light.ambient + 0.05f, 2.f); break;
+        case REDUCE_DIFFUSE: light.diffuse = std::max(light.diffuse - 0.05f, 0.f); break;
+        case RAISE_DIFFUSE: light.diffuse = std::min(light.diffuse + 0.05f, 2.f); break;
+        case RESET: light = LightSettings(); break;
+
+        case TOGGLE_PREVIEW:
+            lightChanged = false;
+            preview = !preview;
+            WNDLight->delButton(ButtonPreview);
+            ButtonPreview = WNDLight->addButton(EditorLightMenu, TOGGLE_PREVIEW, 44, 160, 150, 20, BUTTON_GREY,
+                                                preview ? "Preview: on" : "Preview: off");
+            break;
+
+        case WINDOWQUIT:
+        case MAP_QUIT:
+            if(WNDLight)
+            {
+                PosX = WNDLight->getX();
+                PosY = WNDLight->getY();
+                WNDLight->setWaste();
+                WNDLight = nullptr;
+            }
+            TextDirection = nullptr;
+            TextHeight = nullptr;
+            TextAmbient = nullptr;
+            TextDiffuse = nullptr;
+            TextBpp = nullptr;
+            ButtonPreview = nullptr;
+            return;
+
+        default: return;
+    }
+
+    if(lightChanged)
+    {
+        if(global::s2->getMapObj())
+            global::s2->getMapObj()->setLight(light, preview);
+        else
+            CSurface::setLight(light);
+    }
+
+    // show the current values
+    if(TextDirection)
+        WNDLight->delText(TextDirection);
+    const int degrees = static_cast<int>(std::lround(std::atan2(light.direction.y, light.direction.x) * 180 / 3.14159265f));
+    TextDirection = WNDLight->addText(helpers::format("%d deg", (degrees + 360) % 360), 100, 17, 14, FONT_YELLOW);
+    if(TextHeight)
+        WNDLight->delText(TextHeight);
+    TextHeight = WNDLight->addText(helpers::format("%.1f", light.direction.z), 105, 53, 14, FONT_YELLOW);
+    if(TextAmbient)
+        WNDLight->delText(TextAmbient);
+    TextAmbient = WNDLight->addText(helpers::format("%.2f", light.ambient), 102, 89, 14, FONT_YELLOW);
+    if(TextDiffuse)
+        WNDLight->delText(TextDiffuse);
+    TextDiffuse = WNDLight->addText(helpers::format("%.2f", light.diffuse), 102, 125, 14, FONT_YELLOW);
+    // 8 bpp draws with the shading of the map file, the light is only used by 16 and 32 bpp
+    if(TextBpp)
+        WNDLight->delText(TextBpp);
+    TextBpp = nullptr;
+    if(global::s2->getMapObj() && global::s2->getMapObj()->getBitsPerPixel() == 8)
+        TextBpp = WNDLight->addText("No effect at 8 bpp", 70, 218, 9, FONT_RED);
+}
+
 //"create world" menu
 void callback::EditorCreateMenu(int Param)
 {
@@ -3111,7 +3263,7 @@ void callback::MinimapMenu(int Param)
                 WNDMinimap = new CWindow(MinimapMenu, WINDOWQUIT, global::s2->GameResolution.x / 2 - width / 2 - 6,
                                          global::s2->GameResolution.y / 2 - height / 2 - 15, width + 12, height + 30, "Overview",
                                          WINDOW_NOTHING, WINDOW_CLOSE | WINDOW_MOVE);
-                if(global::s2->RegisterWindow(WNDMinimap) && global::s2->RegisterCallback(MinimapMenu))
+                if(global::s2->RegisterWindow(WNDMinimap) && global::s2->RegisterCallback(MinimapMenu, 250))
                     WndSurface = WNDMinimap->getSurface();
                 else
                 {
@@ -3143,6 +3295,7 @@ void callback::MinimapMenu(int Param)
                            - Position(global::bmpArray[MAPPIC_ARROWCROSS_ORANGE].nx, global::bmpArray[MAPPIC_ARROWCROSS_ORANGE].ny))
                           * Position(TRIANGLE_WIDTH, TRIANGLE_HEIGHT) * scaleNum);
                         MapObj->setDisplayRect(displayRect);
+                        global::s2->WakeCallback(MinimapMenu);
                     }
                 }
             }
@@ -3235,7 +3388,9 @@ void callback::viewer(int Param)
                                     WINDOW_CLOSE | WINDOW_MOVE | WINDOW_RESIZE | WINDOW_MINIMIZE);
             if(global::s2->RegisterWindow(WNDViewer))
             {
-                global::s2->RegisterCallback(viewer);
+                // the picture only changes with the buttons
+                global::s2->RegisterCallback(viewer, CALLBACK_ON_DEMAND);
+                global::s2->WakeCallback(viewer);
                 WNDViewer->addButton(viewer, BACKWARD_100, 0, 0, 35, 20, BUTTON_GREY, "100<-");
                 WNDViewer->addButton(viewer, BACKWARD_10, 35, 0, 35, 20, BUTTON_GREY, "10<-");
                 WNDViewer->addButton(viewer, BACKWARD_1, 70, 0, 35, 20, BUTTON_GREY, "1<-");
@@ -3274,30 +3429,36 @@ void callback::viewer(int Param)
                 index -= 100;
             else
                 index = 0;
+            global::s2->WakeCallback(viewer);
             break;
         case BACKWARD_10:
             if(index - 10 >= 0)
                 index -= 10;
             else
                 index = 0;
+            global::s2->WakeCallback(viewer);
             break;
         case BACKWARD_1:
             if(index - 1 >= 0)
                 index -= 1;
             else
                 index = 0;
+            global::s2->WakeCallback(viewer);
             break;
         case FORWARD_1:
             if(index < MAXBOBBMP - 1)
                 index++;
+            global::s2->WakeCallback(viewer);
             break;
         case FORWARD_10:
             if(index + 10 < MAXBOBBMP - 1)
                 index += 10;
+            global::s2->WakeCallback(viewer);
             break;
         case FORWARD_100:
             if(index + 100 < MAXBOBBMP - 1)
                 index += 100;
+            global::s2->WakeCallback(viewer);
             break;
 
         case WINDOWQUIT:
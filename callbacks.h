@@ -28,6 +28,7 @@ void EditorAnimalMenu(int Param);
 void EditorPlayerMenu(int Param);
 void EditorCreateMenu(int Param);
 void EditorCursorMenu(int Param);
+void EditorLightMenu(int Param);
 
 #ifdef _ADMINMODE
 void debugger(int Param);
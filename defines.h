@@ -104,41 +104,46 @@ struct MapHeaderItem
     Uint16 y;
     Uint32 area; // number of vertices this area has
 };
-// point structure
+// size of the triangles in the current zoom (defined in globals.cpp), the vertex coordinates are calculated with it
+extern unsigned char TRIANGLE_HEIGHT;
+extern unsigned char TRIANGLE_WIDTH;
+extern unsigned char TRIANGLE_INCREASE;
+// point structure (only the data that is needed for drawing and editing, see bobMAP for the rest)
+// the pixel coordinates are not stored, they are calculated from the vertex position and the height
 struct MapNode
 {
-    Uint16 VertexX; /* number of the vertex on x-axis */
-    Uint16 VertexY; /* number of the vertex on y-axis */
-    Sint32 x;
-    Sint32 y; /* calculated with section 1 */
-    int z;    /* calculated with section 1 */
-    Uint8 h;  /* section 1 */
+    // number of the vertex on x-axis and y-axis, copies of vertices that are drawn beyond the map edges
+    // get the position outside the map (e.g. -1 or width) instead of the pixel coordinates of the edge
+    Sint16 VertexX;
+    Sint16 VertexY;
     Sint32 i; /* calculated light values for new shading by SGE (a 16 bit integer shifted left 16 times --> fixed point math for speed) */
-    vector flatVector;
-    vector normVector;
+    Uint8 h;  /* section 1 */
     Uint8 rsuTexture; /* section 2 */
     Uint8 usdTexture; /* section 3 */
     Uint8 road;       /* section 4 */
     Uint8 objectType; /* section 5 */
     Uint8 objectInfo; /* section 6 */
     Uint8 animal;     /* section 7 */
-    Uint8 unknown1;   /* section 8 */
     Uint8 build;      /* section 9 */
-    Uint8 unknown2;   /* section 10 */
-    Uint8 unknown3;   /* section 11 */
     Uint8 resource;   /* section 12 */
     Uint8 shading;    /* section 13 */
-    Uint8 unknown5;   /* section 14 */
+
+    // pixel coordinates (odd rows are shifted by half a triangle), y is lifted by the height
+    Sint32 getX() const { return VertexX * TRIANGLE_WIDTH + ((VertexY & 1) ? TRIANGLE_WIDTH : TRIANGLE_WIDTH / 2); }
+    Sint32 getY() const { return VertexY * TRIANGLE_HEIGHT - getZ(); }
+    Sint32 getZ() const { return TRIANGLE_INCREASE * (h - 0x0A); }
 
     operator IntVector() const
     {
         IntVector result;
-        result.x = x;
-        result.y = y;
-        result.z = z;
+        result.x = getX();
+        result.y = getY();
+        result.z = getZ();
         return result;
     }
 };
+// the map is held in memory and in the undo buffer vertex by vertex, so keep it small
+static_assert(sizeof(MapNode) <= 24, "MapNode should not grow");
 // structure for display, cause SDL_Rect's datatypes are too small
 using DisplayRectangle = RectBase<Sint32>;
 using Point16 = Point<Sint16>;
@@ -155,10 +160,11 @@ struct bobMAP
 {
     Uint16 height;
     Uint16 height_old;
-    Uint16 height_pixel;
     Uint16 width;
     Uint16 width_old;
-    Uint16 width_pixel;
+    // size in pixels (32 bit, large maps exceed 16 bit when zoomed in)
+    Sint32 height_pixel;
+    Sint32 width_pixel;
     MapType type;
     Uint8 player;
     // these are the original values
@@ -167,15 +173,30 @@ struct bobMAP
     // 250 items from the big map header
     std::array<MapHeaderItem, 250> header;
     std::vector<MapNode> vertex;
+    // the rarely used data of the vertices is kept in one array per field (indexed like vertex),
+    // so drawing and editing only move the data of MapNode through the cache
+    // normal of the RightSideUp triangle below each vertex and normal of each vertex (only needed to calculate MapNode::i)
+    std::vector<vector> flatVectors;
+    std::vector<vector> normVectors;
+    // sections 8, 10, 11 and 14 of the map file (only loaded and saved)
+    std::vector<Uint8> unknown1, unknown2, unknown3, unknown5;
     MapNode& getVertex(unsigned x, unsigned y) { return vertex[y * width + x]; }
     MapNode& getVertex(Point32 pos) { return vertex[pos.y * width + pos.x]; }
     const MapNode& getVertex(unsigned x, unsigned y) const { return vertex[y * width + x]; }
     const MapNode& getVertex(Point32 pos) const { return vertex[pos.y * width + pos.x]; }
+    vector& getFlatVector(unsigned x, unsigned y) { return flatVectors[y * width + x]; }
+    const vector& getFlatVector(unsigned x, unsigned y) const { return flatVectors[y * width + x]; }
+    vector& getNormVector(unsigned x, unsigned y) { return normVectors[y * width + x]; }
+    const vector& getNormVector(unsigned x, unsigned y) const { return normVectors[y * width + x]; }
+    // resizes vertex and the arrays of the rarely used data to width * height
+    void resizeVertices();
     std::vector<DescIdx<TerrainDesc>> s2IdToTerrain;
     // Initializes or updates the vertex indices and coordinates
     void initVertexCoords();
-    /// Updates x,y,z positions (e.g. after height change)
+    /// Updates the size in pixels (e.g. after zooming)
     void updateVertexCoords();
+    // bytes used by the vertex data of the map
+    size_t getMemoryUsage() const;
 
     const std::string& getName() const { return name; }
     const std::string& getAuthor() const { return author; }
@@ -1180,6 +1201,8 @@ enum
 #define MAXWINDOWS 100
 // maximum number of callbacks
 #define MAXCALLBACKS 100
+// period of callbacks that are only called after CGame::WakeCallback()
+#define CALLBACK_ON_DEMAND 0xFFFFFFFF
 // maximum number of buttons that can be created WITHIN a menu or window
 #define MAXBUTTONS 50
 // maximum number of texts that can be written WITHIN a menu or window
@@ -1198,7 +1221,7 @@ enum
 #define MAXMAPHEIGHT 1024
 
 // triangle values
-// these values are now handled in globals.h and globals.cpp, cause they must be changeable for the zoom mode
+// these values are now declared before MapNode and defined in globals.cpp, cause they must be changeable for the zoom mode
 //#define TRIANGLE_HEIGHT             28  //30 --> old value, 28 is the right
 //#define TRIANGLE_WIDTH              56  //54 --> old value, 56 is the right
 //#define TRIANGLE_INCREASE            5  //depends on TRIANGLE_HEIGHT --> TRIANGLE_HEIGHT/TRIANGLE_INCREASE must be greater than 5
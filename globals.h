@@ -1,6 +1,7 @@
 #ifndef _GLOBALS_H
 #define _GLOBALS_H
 
+#include "defines.h"
 #include "gameData/WorldDescription.h"
 #include <SDL.h>
 #include <vector>
@@ -26,10 +27,6 @@ extern std::string userMapsPath;
 extern WorldDescription worldDesc;
 } // namespace global
 
-extern unsigned char TRIANGLE_HEIGHT;
-extern unsigned char TRIANGLE_WIDTH;
-extern unsigned char TRIANGLE_INCREASE;
-
 extern Uint8 gouData[3][256][256];
 
 #endif